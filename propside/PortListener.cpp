@@ -28,10 +28,11 @@
  * We use Polling for the port because events are not
  * well behaved in the QextSerialPort library on windows.
  */
-PortListener::PortListener(QObject *parent, Console *term) : QThread(parent)
+PortListener::PortListener(QObject *parent, Console *term) : QThread(parent), rxPending(0)
 {
     terminal = term;
     useSerial = false;
+    capture = NULL;
 
     /*
      * removed EVENT_DRIVEN code because it doesn't work on all platforms
@@ -135,6 +136,11 @@ void PortListener::close()
         if(serialPort == NULL) return;
         disconnect(this, SIGNAL(updateEvent(QextSerialPort*)), this, SLOT(updateReady(QextSerialPort*)));
         serialPort->close();
+        // close wakes the listener, so this doesn't take long
+        if(isRunning())
+            wait(1000);
+        rxQueue.clear();
+        rxPending.fetchAndStoreOrdered(0);
     }
     else {
         disconnect(wifiPort, SIGNAL(updateEvent(XEsp8266port*)), this, SLOT(updateReady(XEsp8266port*)));
@@ -153,6 +159,15 @@ void PortListener::setTerminalWindow(QPlainTextEdit *editor)
     textEditor = editor;
 }
 
+/*
+ * Set before the port is opened. The file itself is opened and closed
+ * while the listener runs.
+ */
+void PortListener::setCaptureFile(CaptureFile *file)
+{
+    capture = file;
+}
+
 void PortListener::send(QByteArray &data)
 {
     if (useSerial) {
@@ -171,11 +186,22 @@ void PortListener::onDsrChanged(bool status)
         qDebug() << "device was turned off";
 }
 
+/*
+ * Runs in the GUI thread. Takes everything the listener has queued.
+ * The pending flag is cleared first so bytes queued while we work
+ * post another event. The queue is always drained so the listener
+ * never waits on it; bytes are dropped while the terminal is disabled.
+ */
 void PortListener::updateReady(QextSerialPort* port)
 {
+    Q_UNUSED(port);
+    rxPending.fetchAndStoreOrdered(0);
+    QByteArray data = rxQueue.take();
+    if(data.length() < 1)
+        return;
     if(terminal != NULL)
         if(terminal->enabled())
-            terminal->updateReady(port);
+            terminal->updateReady(data);
 }
 
 void PortListener::updateReady(XEsp8266port* port)
@@ -193,19 +219,59 @@ void PortListener::updateReady(XEsp8266port* port)
 #define POLL_DELAY 10
 #endif
 
+// how long to block before checking the port is still open
+#define WAIT_LIMIT 500
+#define READ_CHUNK 4096
+// most bytes waiting for the terminal while capturing
+#define PREVIEW_LIMIT 2048
+
 /*
  * This is the port listener thread.
- * We have to use polling so that we can share the loader port.
+ * It blocks until the port has data, reads it here, and queues it
+ * for the GUI. Only the first chunk after the GUI has caught up
+ * posts an event, so a fast stream doesn't flood the event loop.
+ * Closing the port wakes the wait so the loader can have the port.
+ *
+ * While capturing, every byte goes to the file from here and the
+ * terminal only gets what fits in a small preview; the rest is
+ * dropped from the view rather than slowing the capture.
  */
 void PortListener::run()
 {
+    char buff[READ_CHUNK];
+
     if (useSerial) {
         while(serialPort->isOpen()) {
-            if(terminal->serialPollEnabled()) {
+            if(!serialPort->waitForReadyRead(WAIT_LIMIT))
+                continue;
+            qint64 length = serialPort->read(buff, READ_CHUNK);
+            if(length < 1) {
+                // readable with nothing to read means the device went away
                 msleep(POLL_DELAY);
-                QApplication::processEvents();
-                if(terminal->enabled()) {
+                continue;
+            }
+            if(capture != NULL && capture->isOpen()) {
+                capture->write(buff, (int)length);
+                int room = PREVIEW_LIMIT - rxQueue.count();
+                if(room > 0) {
+                    rxQueue.put(buff, (int)length < room ? (int)length : room);
+                    if(rxPending.fetchAndStoreOrdered(1) == 0)
+                        emit updateEvent(serialPort);
+                }
+                continue;
+            }
+            int sent = 0;
+            while(sent < length) {
+                int put = rxQueue.put(buff+sent, (int)length-sent);
+                sent += put;
+                // only post when something new was queued
+                if(put > 0 && rxPending.fetchAndStoreOrdered(1) == 0)
                     emit updateEvent(serialPort);
+                if(sent < length) {
+                    // GUI is behind. its pending event will drain the queue
+                    if(!serialPort->isOpen())
+                        break;
+                    msleep(POLL_DELAY);
                 }
             }
         }
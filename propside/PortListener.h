@@ -22,6 +22,8 @@
 
 #include "console.h"
 #include "xesp8266port.h"
+#include "bytequeue.h"
+#include "capturefile.h"
 
 class PortListener : public QThread
 {
@@ -35,6 +37,7 @@ public:
     void close();
     bool isOpen();
     void setTerminalWindow(QPlainTextEdit *editor);
+    void setCaptureFile(CaptureFile *file);
     void send(QByteArray &data);
     int  readData(char *buff, int length);
     void run();
@@ -49,6 +52,10 @@ private:
     XEsp8266port     *wifiPort;
     QPlainTextEdit  *textEditor;
 
+    ByteQueue       rxQueue;
+    QAtomicInt      rxPending;
+    CaptureFile     *capture;
+
 private slots:
     void onDsrChanged(bool status);
     void updateReady(QextSerialPort*);
@@ -32,13 +32,26 @@
 #include "qtversion.h"
 #include "PropellerID.h"
 
-PropellerID::PropellerID(QObject *parent) : QThread(parent)
+/*
+ * QThread::msleep is protected in Qt4.
+ */
+class ProbeDelay : public QThread
+{
+public:
+    static void msleep(unsigned long msecs) {
+        QThread::msleep(msecs);
+    }
+};
+
+PropellerID::PropellerID()
 {
     port = new QextSerialPort(QextSerialPort::Polling);
     pload_verbose = 0;
+    pload_delay = 0;
     rxhead = 0;
     rxtail = 0;
     resetType = RESET_BY_DTR;
+    version = 0;
     LFSR = 80; // 'P'
 }
 
@@ -52,16 +65,12 @@ int PropellerID::isDevice(QString portName)
     return findprop(portName.toLatin1());
 }
 
-void PropellerID::run()
-{
-    while(port->isOpen()) {
-        msleep(25);
-        QApplication::processEvents();
-        emit portEvent();
-    }
-}
-
-void PropellerID::portHandler()
+/**
+ * read whatever the port has into the receive queue
+ * @param timeout - milliseconds to wait for data if none is queued
+ * @returns number of bytes added
+ */
+int PropellerID::fill(int timeout)
 {
     /*
      * TODO Queue is broken. Fix it later.
@@ -79,12 +88,21 @@ void PropellerID::portHandler()
      */
     int size = port->bytesAvailable();
     if(size < 1) {
-        return;
+        if(timeout < 1 || !port->waitForReadyRead(timeout))
+            return 0;
     }
 #if 1
     if (rxhead >= rxtail) {
-        size = RXSIZE-(rxhead-rxtail);
-        size = port->read(&rxqueue[rxhead], size);
+        /* read up to the end of the queue, then wrap to the front */
+        int room = RXSIZE+1-rxhead;
+        if(rxtail == 0)
+            room--; // head may not catch up to tail
+        size = port->read(&rxqueue[rxhead], room);
+        if(size == room && rxtail > 1) {
+            int more = port->read(&rxqueue[0], rxtail-1);
+            if(more > 0)
+                size += more;
+        }
     } else {
         size = port->read(&rxqueue[rxhead], rxtail-rxhead-1);
     }
@@ -98,28 +116,10 @@ void PropellerID::portHandler()
         size = port->read(&rxqueue[0], RXSIZE);
     }
 #endif
+    if(size < 0)
+        return 0;
     rxhead = (rxhead + size) & RXSIZE;
     // if (pload_verbose) qDebug() << size << " bytes read H" << rxhead << "T" << rxtail;
-}
-
-/**
- * receive a buffer
- * @param buff - char pointer to buffer
- * @param n - number of bytes in buffer to read
- * @returns number of bytes read
- */
-int PropellerID::rx(char* buff, int n)
-{
-    int size = 0;
-    while(rxhead == rxtail)
-        ;
-    while(rxhead != rxtail) {
-        if(size >= n)
-            break;
-        buff[size] = rxqueue[rxtail];
-        size++;
-        rxtail = (rxtail + size) & RXSIZE;
-    }
     return size;
 }
 
@@ -132,7 +132,6 @@ int PropellerID::rx(char* buff, int n)
 int PropellerID::tx(char* buff, int n)
 {
     int size = port->write((const char*)buff, n);
-    QApplication::processEvents();
     return size;
 }
 
@@ -146,18 +145,14 @@ int PropellerID::tx(char* buff, int n)
 int PropellerID::rx_timeout(char* buff, int n, int timeout)
 {
     int size = 0;
-    while(rxhead == rxtail) {
-        msleep(1);
-        QApplication::processEvents();
-        if(timeout-- < 0)
-            break;
-    }
-    while(timeout > 0 && rxhead != rxtail) {
+    if(rxhead == rxtail)
+        fill(timeout);
+    while(rxhead != rxtail) {
         if(size >= n)
             break;
         buff[size] = rxqueue[rxtail];
         size++;
-        rxtail = (rxtail + size) & RXSIZE;
+        rxtail = (rxtail + 1) & RXSIZE;
     }
     return size == 0 ? SERIAL_TIMEOUT : size;
 }
@@ -171,16 +166,16 @@ void PropellerID::hwreset(void)
 {
     if(this->resetType == RESET_BY_DTR) {
         port->setDtr(true);
-        msleep(10);
+        ProbeDelay::msleep(10);
         port->setDtr(false);
-        msleep(90);
+        ProbeDelay::msleep(90);
         port->flush();
     }
     else {
         port->setRts(true);
-        msleep(10);
+        ProbeDelay::msleep(10);
         port->setRts(false);
-        msleep(90);
+        ProbeDelay::msleep(90);
         port->flush();
     }
 }
@@ -358,8 +353,7 @@ void PropellerID::flushPort()
 {
     int size = 0;
     do {
-        msleep(5);
-        QApplication::processEvents();
+        ProbeDelay::msleep(5);
         size = port->bytesAvailable();
         //if (pload_verbose) qDebug("Flushing port %d", size);
         port->readAll();
@@ -375,7 +369,7 @@ void PropellerID::flushPort()
  */
 int PropellerID::findprop(const char* name)
 {
-    int version = 0;
+    version = 0;
 
     if (pload_verbose)
         qDebug("\nChecking for Propeller on port %s", name);
@@ -400,11 +394,8 @@ int PropellerID::findprop(const char* name)
     rxhead = 0;
     rxtail = 0;
 
-    connect(this, SIGNAL(portEvent()), this, SLOT(portHandler()));
-    start();
     hwreset();
     version = hwfind(1); // retry once
-    disconnect(this, SIGNAL(portEvent()), this, SLOT(portHandler()));
 
     if (pload_verbose) {
         if(version) {
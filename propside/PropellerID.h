@@ -23,15 +23,21 @@
 #include <QThread>
 #include "qextserialport.h"
 
-class PropellerID : public QThread
+/*
+ * PropellerID looks for a Propeller on one port. It reads the port
+ * directly and never touches the event loop, so a probe can run on
+ * any thread. PropellerScan uses one per port to probe in parallel.
+ */
+class PropellerID
 {
-Q_OBJECT
 public:
-    PropellerID(QObject *parent = 0);
+    PropellerID();
     virtual ~PropellerID();
 
     int  isDevice(QString port);
-    void run();
+    int  getVersion() {
+        return version;
+    }
 
 
     enum { RESET_BY_DTR = 1 };
@@ -47,6 +53,7 @@ public:
 private:
 
     int resetType;
+    int version;
     QextSerialPort *port;
 
     enum { RXSIZE = (1<<10)-1 };
@@ -56,12 +63,11 @@ private:
     char rxqueue[RXSIZE+1];
 
     /**
-     * receive a buffer
-     * @param buff - char pointer to buffer
-     * @param n - number of bytes in buffer to read
-     * @returns number of bytes read
+     * read whatever the port has into the receive queue
+     * @param timeout - milliseconds to wait for data if none is queued
+     * @returns number of bytes added
      */
-    int rx(char* buff, int n);
+    int fill(int timeout);
 
     /**
      * transmit a buffer
@@ -164,13 +170,6 @@ private:
      * @returns 1 if found, 0 if not found, or -1 if port not opened.
      */
     int findprop(const char* port);
-
-private slots:
-    void portHandler();
-
-signals:
-    void portEvent();
-
 };
 
 #endif // PROPELLERID_H
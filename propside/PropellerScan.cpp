@@ -0,0 +1,190 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PropellerScan.h"
+
+PropellerScan::PropellerScan(QObject *parent) : QObject(parent)
+{
+    rtsReset = false;
+}
+
+/*
+ * Probes left running by a firstOnly scan must finish before their
+ * ports and thread objects go away.
+ */
+PropellerScan::~PropellerScan()
+{
+    foreach(PropellerProbe *probe, probes) {
+        probe->wait();
+        delete probe;
+    }
+    probes.clear();
+}
+
+/*
+ * Found ports are only good for one reset type.
+ */
+void PropellerScan::setRtsReset(bool rts)
+{
+    if(rts != rtsReset)
+        found.clear();
+    rtsReset = rts;
+}
+
+void PropellerScan::invalidate()
+{
+    found.clear();
+}
+
+/*
+ * Remember what finished probes found and delete them.
+ */
+void PropellerScan::collect()
+{
+    for(int n = probes.count()-1; n > -1; n--) {
+        PropellerProbe *probe = probes.at(n);
+        if(!probe->isFinished())
+            continue;
+        probe->wait();
+        if(probe->status() > 0)
+            found.insert(probe->portName(), probe->version());
+        probes.removeAt(n);
+        delete probe;
+    }
+}
+
+/*
+ * Probe ports and return a Result for each, in the order given.
+ * With firstOnly the scan returns as soon as the first port in list
+ * order is known to have a Propeller; the other probes finish on their
+ * own and only the hit is returned. Returns an empty list if nothing
+ * is found in that case.
+ */
+QList<PropellerScan::Result> PropellerScan::scan(QStringList ports, bool firstOnly, bool useCache)
+{
+    QList<Result> results;
+    QList<PropellerProbe*> mine;
+    QEventLoop loop;
+
+    collect();
+    if(!useCache)
+        found.clear();
+
+    for(int n = 0; n < ports.count(); n++) {
+        QString name = ports.at(n);
+        if(found.contains(name)) {
+            if(firstOnly) {
+                Result r;
+                r.port = name;
+                r.status = 1;
+                r.version = found.value(name);
+                results.append(r);
+                return results;
+            }
+            mine.append(NULL);
+            continue;
+        }
+        bool busy = false;
+        foreach(PropellerProbe *probe, probes) {
+            if(probe->portName() == name)
+                busy = true;
+        }
+        if(busy) {
+            mine.append(NULL);
+            continue;
+        }
+        PropellerProbe *probe = new PropellerProbe(name, rtsReset);
+        connect(probe, SIGNAL(finished()), &loop, SLOT(quit()));
+        probes.append(probe);
+        mine.append(probe);
+        probe->start();
+    }
+
+    /*
+     * finished() is queued to this thread, so a probe that ends before
+     * exec() still ends the next exec().
+     */
+    forever {
+        bool done = true;
+        for(int n = 0; n < mine.count(); n++) {
+            PropellerProbe *probe = mine.at(n);
+            if(probe == NULL)
+                continue;
+            if(!probe->isFinished()) {
+                done = false;
+                break;
+            }
+            if(firstOnly && probe->status() > 0)
+                break;
+        }
+        if(done)
+            break;
+        loop.exec();
+    }
+
+    for(int n = 0; n < mine.count(); n++) {
+        PropellerProbe *probe = mine.at(n);
+        Result r;
+        r.port = ports.at(n);
+        if(probe != NULL) {
+            if(!probe->isFinished())
+                break;
+            r.status = probe->status();
+            r.version = probe->version();
+        }
+        else if(found.contains(r.port)) {
+            r.status = 1;
+            r.version = found.value(r.port);
+        }
+        else {
+            r.status = -1;  // an earlier scan's probe still has the port
+            r.version = 0;
+        }
+        if(firstOnly) {
+            if(r.status > 0) {
+                results.append(r);
+                break;
+            }
+            continue;
+        }
+        results.append(r);
+    }
+
+    collect();
+    return results;
+}
+
+PropellerProbe::PropellerProbe(QString port, bool rts, QObject *parent) : QThread(parent)
+{
+    this->port = port;
+    rtsReset = rts;
+    result = 0;
+    chip = 0;
+}
+
+void PropellerProbe::run()
+{
+    PropellerID id;
+    if(rtsReset)
+        id.setRtsReset();
+    else
+        id.setDtrReset();
+    result = id.isDevice(port);
+    chip = id.getVersion();
+}
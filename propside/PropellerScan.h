@@ -0,0 +1,87 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROPELLERSCAN_H
+#define PROPELLERSCAN_H
+
+#include "qtversion.h"
+#include "PropellerID.h"
+
+class PropellerProbe;
+
+/*
+ * PropellerScan probes a list of ports for Propellers, one thread per
+ * port, so identifying boards costs one probe instead of one per port.
+ *
+ * Ports where a Propeller was found are remembered until invalidate()
+ * is called, normally from PortConnectionMonitor::portChanged. Ports
+ * without a Propeller are always probed again because a board may be
+ * powered up behind an existing USB serial port.
+ */
+class PropellerScan : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PropellerScan(QObject *parent = 0);
+    virtual ~PropellerScan();
+
+    struct Result {
+        QString port;
+        int     status;     // as PropellerID::isDevice: 1 found, 0 not found, -1 busy
+        int     version;
+    };
+
+    void setRtsReset(bool rts);
+    QList<Result> scan(QStringList ports, bool firstOnly, bool useCache = true);
+
+public slots:
+    void invalidate();
+
+private:
+    void collect();
+
+    QMap<QString,int>       found;  // port to chip version
+    QList<PropellerProbe*>  probes; // still running
+    bool rtsReset;
+};
+
+/*
+ * Runs one PropellerID probe. The serial port is created inside run()
+ * so it belongs to the probe thread.
+ */
+class PropellerProbe : public QThread
+{
+    Q_OBJECT
+public:
+    PropellerProbe(QString port, bool rts, QObject *parent = 0);
+
+    void run();
+
+    QString portName()  { return port; }
+    int     status()    { return result; }
+    int     version()   { return chip; }
+
+private:
+    QString port;
+    bool    rtsReset;
+    int     result;
+    int     chip;
+};
+
+#endif // PROPELLERSCAN_H
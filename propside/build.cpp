@@ -19,6 +19,7 @@
 
 #include "build.h"
 #include "Sleeper.h"
+#include "toolrunner.h"
 
 Build::Build(ProjectOptions *projopts, QPlainTextEdit *compstat, QLabel *stat, QLabel *progsize, QProgressBar *progbar, QComboBox *cb, Properties *p)
 {
@@ -31,7 +32,10 @@ Build::Build(ProjectOptions *projopts, QPlainTextEdit *compstat, QLabel *stat, Q
     properties = p;
 
     process = new QProcess();
+    buildJobs = NULL;
     blinker = new Blinker(status);
+    sizesPending = -1;
+    sizesDone = false;
 
     connect(blinker, SIGNAL(statusNone()), this, SLOT(statusNone()));
     connect(blinker, SIGNAL(statusFailed()), this, SLOT(statusFailed()));
@@ -75,11 +79,13 @@ QString Build::getOutputPath(QString projfile)
 
 void Build::abortProcess()
 {
+    if(buildJobs != NULL)
+        buildJobs->abort();
     if(procDone != true) {
         procMutex.lock();
         procDone = true;
         procMutex.unlock();
-        QApplication::processEvents();
+        ToolRunner::wakeAll();
         //process->kill(); // don't kill here. let the user process that is waiting kill it.
     }
 }
@@ -105,7 +111,11 @@ int  Build::startProgram(QString program, QString workpath, QStringList args, Du
     process->setProperty("Name", QVariant(program));
     process->setProperty("IsLoader", QVariant(false));
 
+    buildOutput.startStream();
     if(dump == this->DumpReadSizes) {
+        sizesOutput.startStream();
+        sizesPending = -1;
+        sizesDone = false;
         disconnect(process, SIGNAL(readyReadStandardOutput()),this,SLOT(procReadyRead()));
         connect(process, SIGNAL(readyReadStandardOutput()),this,SLOT(procReadyReadSizes()));
     }
@@ -123,6 +133,7 @@ int  Build::startProgram(QString program, QString workpath, QStringList args, Du
 
     qDebug() << "startProgram 1 time" << ptime.elapsed();
 
+    ToolRunner runner(process);
     process->start(program,args);
 
     qDebug() << "startProgram 2 time" << ptime.elapsed();
@@ -131,17 +142,15 @@ int  Build::startProgram(QString program, QString workpath, QStringList args, Du
 
     /* process Qt application events until procDone
      */
-    while(procDone == false) {
-        //qDebug() << "startProgram 3 time" << ptime.elapsed();
-        Sleeper::ms(50);
-        QApplication::processEvents();
-    }
+    runner.wait(&procDone);
     qDebug() << "startProgram 3 time" << ptime.elapsed();
 
+    flushOutput(dump);
+
     int killed = 0;
     if(process->state() == QProcess::Running) {
         process->kill();
-        Sleeper::ms(50);
+        process->waitForFinished(1000);
         compileStatus->appendPlainText(tr("Program killed by user."));
         status->setText(status->text() + tr(" Done."));
         killed = -1;
@@ -156,6 +165,82 @@ int  Build::startProgram(QString program, QString workpath, QStringList args, Du
     return process->exitCode() | killed;
 }
 
+/*
+ * Run independent invocations of program concurrently.
+ * Uses up to the Parallel Build Jobs property number of processes.
+ * Each job's output is printed as a block when the job finishes.
+ * Returns 0 only if all jobs pass. On failure no new jobs are started.
+ * If results is given it receives each job's exit code, -1 if not run.
+ */
+int  Build::startPrograms(QString program, QString workpath, QList<QStringList> argsList, QList<int> *results)
+{
+    program = shortFileName(program);
+    program = aSideCompilerPath+program;
+
+    ToolRunner::waitThread(blinker);
+    statusNone();
+
+    BuildJobs jobs(properties->getBuildJobs());
+    foreach(QStringList jargs, argsList) {
+        jobs.addJob(program, workpath, jargs);
+    }
+    connect(&jobs, SIGNAL(jobFinished(int)), this, SLOT(buildJobFinished(int)));
+
+    procDone = false;
+    procResultError = false;
+    buildJobs = &jobs;
+    int rc = jobs.run();
+    buildJobs = NULL;
+    procDone = true;
+
+    if(results != 0) {
+        results->clear();
+        for(int n = 0; n < jobs.count(); n++)
+            results->append(jobs.jobRan(n) ? jobs.jobExitCode(n) | (jobs.jobFailed(n) ? 1 : 0) : -1);
+    }
+
+    if(jobs.isAborted()) {
+        compileStatus->appendPlainText(tr("Program killed by user."));
+        status->setText(status->text() + tr(" Done."));
+        return -1;
+    }
+
+    /*
+     * Report the first failure in project order. Job output is already
+     * in the status pane, so like procFinished no output is passed here.
+     */
+    for(int n = 0; n < jobs.count(); n++) {
+        if(jobs.jobFailed(n)) {
+            int code = jobs.jobExitCode(n) ? jobs.jobExitCode(n) : 1;
+            buildResult(jobs.jobExitStatus(n), code, jobs.jobProgram(n), "");
+            return code;
+        }
+    }
+    buildResult(QProcess::NormalExit, 0, program, "");
+    return rc;
+}
+
+void Build::buildJobFinished(int n)
+{
+    BuildJobs *jobs = qobject_cast<BuildJobs*>(sender());
+    if(jobs == NULL)
+        return;
+
+    QStringList args = jobs->jobArgs(n);
+    QString argstr = "";
+    for(int m = 0; m < args.length(); m++)
+        argstr += " "+args[m];
+    qDebug() << jobs->jobProgram(n)+argstr;
+    compileStatus->appendPlainText(shortFileName(jobs->jobProgram(n))+argstr);
+
+    QString output = QString(jobs->jobOutput(n)).replace("\r\n","\n").trimmed();
+    if(output.length() > 0) {
+        int first = compileStatus->document()->blockCount();
+        compileStatus->appendPlainText(output);
+        buildOutput.addBlocks(compileStatus->document(), first);
+    }
+}
+
 void Build::procError(QProcess::ProcessError error)
 {
     if(procDone == true)
@@ -206,53 +291,94 @@ void Build::procReadyReadCat()
  */
 void Build::procReadyReadSizes()
 {
-    int rc;
-    bool ok;
     QByteArray bytes = process->readAllStandardOutput();
     if(bytes.length() == 0)
         return;
 
-    if(QString(bytes).contains("file format elf32-propeller",Qt::CaseInsensitive)) {
+    QStringList lines = sizesOutput.addBytes(bytes);
+    foreach(QString line, lines)
+        addSizesLine(line);
+}
+
+/*
+ * A section counts toward code size if the flags line after it says LOAD.
+ * .bss only takes memory and nothing after the heap is counted.
+ */
+void Build::addSizesLine(const QString &line)
+{
+    bool ok;
+
+    if(line.contains("file format elf32-propeller",Qt::CaseInsensitive)) {
         this->codeSize = 0;
         this->memorySize = 0;
+        sizesPending = -1;
+        sizesDone = false;
+        return;
     }
-    QStringList lines = QString(bytes).split("\n",QString::SkipEmptyParts);
-    int len = lines.length();
-    for (int n = 0; n < len; n++) {
-        QString line = lines[n];
-        if(line.length() > 0) {
-            QString ms = line.mid(line.indexOf("."));
-            QRegExp regex("[ \t]");
-            QStringList more = line.split(regex,QString::SkipEmptyParts);
-            if(ms.contains(".bss",Qt::CaseInsensitive)) {
-                if(more.length() > 2) {
-                    rc = more.at(2).toInt(&ok,16);
-                    if(ok) {
-                        this->memorySize += rc;
-                    }
-                }
-            }
-            else
-            if(ms.contains("heap",Qt::CaseInsensitive)) {
-                //this->codeSize += 4;
-                //this->memorySize += 4;
-                break;
-            }
-            else if (n < len-1){
-                if(QString(lines.at(n+1)).contains("load", Qt::CaseInsensitive)) {
-                    if(more.length() > 2) {
-                        rc = more.at(2).toInt(&ok,16);
-                        if(ok) {
-                            this->codeSize += rc;
-                            this->memorySize += rc;
-                        }
-                    }
-                }
+    if(sizesDone)
+        return;
+
+    if(sizesPending > -1 && line.contains("load", Qt::CaseInsensitive)) {
+        this->codeSize += sizesPending;
+        this->memorySize += sizesPending;
+    }
+    sizesPending = -1;
+
+    QString ms = line.mid(line.indexOf("."));
+    QStringList more = line.simplified().split(' ');
+    if(ms.contains(".bss",Qt::CaseInsensitive)) {
+        if(more.length() > 2) {
+            int rc = more.at(2).toInt(&ok,16);
+            if(ok) {
+                this->memorySize += rc;
             }
         }
     }
+    else if(ms.contains("heap",Qt::CaseInsensitive)) {
+        sizesDone = true;
+    }
+    else if(more.length() > 2) {
+        int rc = more.at(2).toInt(&ok,16);
+        if(ok) {
+            sizesPending = rc;
+        }
+    }
+}
+
+/*
+ * Show the last unfinished line once the program is done.
+ */
+void Build::flushOutput(DumpType dump)
+{
+    if(dump == DumpReadSizes) {
+        QString line = sizesOutput.flush();
+        if(line.length() > 0)
+            addSizesLine(line);
+        return;
+    }
+
+    QString line = buildOutput.flush();
+    if(line.length() > 0)
+        insertStatus("\n"+line);
+}
+
+/*
+ * Insert text at the end of the status and classify the lines it added.
+ */
+void Build::insertStatus(const QString &text)
+{
+    QTextDocument *doc = compileStatus->document();
+    compileStatus->moveCursor(QTextCursor::End);
+    int first = doc->blockCount()-1;
+    compileStatus->insertPlainText(text);
+    buildOutput.addBlocks(doc, first);
 }
 
+/*
+ * Output is assembled into lines and the text for one read is inserted
+ * into the status as a block. Diagnostics are recorded with the status
+ * block they land in.
+ */
 void Build::procReadyRead()
 {
     QByteArray bytes = process->readAllStandardOutput();
@@ -264,7 +390,6 @@ void Build::procReadyRead()
 #else
     QString eol("\n");
 #endif
-    bytes = bytes.replace("\r\n","\n");
 
     // bstc doesn't return good exit status
     QString progname;
@@ -272,121 +397,99 @@ void Build::procReadyRead()
     if(pvar.canConvert(QVariant::String)) {
         progname = pvar.toString();
     }
-    bool isbstc = false;
-    if(progname.contains("bstc",Qt::CaseInsensitive)) {
-        isbstc = true;
-        if(QString(bytes).contains("Error",Qt::CaseInsensitive)) {
-            procResultError = true;
-        }
-        if(QString(bytes).contains("longs",Qt::CaseInsensitive)) {
-            bytes = bytes.replace("longs", "bytes");
-        }
-    }
-    if(progname.contains("propbasic",Qt::CaseInsensitive)) {
-        isbstc = true;
-        if(QString(bytes).contains("Error",Qt::CaseInsensitive) && !QString(bytes).contains("0 Error",Qt::CaseInsensitive)) {
-            procResultError = true;
-        }
-        if(QString(bytes).contains("longs",Qt::CaseInsensitive)) {
-            bytes = bytes.replace("longs", "bytes");
-        }
-    }
-
-    if(progname.contains("propeller-elf-gcc") && bytes.contains("gcc version")) {
-        QString line = QString(bytes);
-        QStringList lines = line.split("gcc version",QString::SkipEmptyParts);
-        if(lines.count() > 0) {
-            compileStatus->insertPlainText(" GCC "+QString(lines[1]).trimmed());
-            return;
-        }
-    }
-
-    QStringList lines = QString(bytes).split("\n",QString::SkipEmptyParts);
-    if(bytes.contains("bytes")) {
-        for (int n = 0; n < lines.length(); n++) {
-            QString line = lines[n];
-            if(line.length() > 0) {
-                if(line.indexOf("\r") > -1) {
-                    QStringList more = line.split("\r",QString::SkipEmptyParts);
-                    lines.removeAt(n);
-                    for(int m = more.length()-1; m > -1; m--) {
-                        QString ms = more.at(m);
-                        if(ms.contains("bytes",Qt::CaseInsensitive))
-                            lines.insert(n,more.at(m));
-                        if(ms.contains("loading",Qt::CaseInsensitive))
-                            lines.insert(n,more.at(m));
-                    }
-                }
+    bool isbstc = progname.contains("bstc",Qt::CaseInsensitive);
+    bool isbasic = progname.contains("propbasic",Qt::CaseInsensitive);
+    bool isgcc = progname.contains("propeller-elf-gcc");
+
+    QStringList lines = buildOutput.addBytes(bytes);
+
+    if(isgcc) {
+        foreach(QString line, lines) {
+            int pos = line.indexOf("gcc version");
+            if(pos > -1) {
+                compileStatus->insertPlainText(" GCC "+line.mid(pos+11).trimmed());
+                return;
             }
         }
     }
 
+    QString text;
     for (int n = 0; n < lines.length(); n++) {
         QString line = lines[n];
-        if(line.length() > 0) {
-            compileStatus->moveCursor(QTextCursor::End);
-            if(line.contains("Propeller Version",Qt::CaseInsensitive)) {
-                compileStatus->insertPlainText(line+eol);
-                progress->setValue(0);
-            }
-            else
-            if(line.contains("loading",Qt::CaseInsensitive) && !isbstc) {
-                progMax = 0;
-                progress->setValue(0);
-                compileStatus->insertPlainText(line+eol);
-            }
-            else
-            if(line.contains("writing",Qt::CaseInsensitive)) {
-                progMax = 0;
-                progress->setValue(0);
-            }
-            else
-            if(line.contains("Download OK",Qt::CaseInsensitive)) {
-                progress->setValue(100);
-                compileStatus->insertPlainText(line+eol);
-            }
-            else
-            if(line.contains("sent",Qt::CaseInsensitive)) {
-                compileStatus->insertPlainText(line+eol);
+        if(isbstc || isbasic) {
+            if(line.contains("Error",Qt::CaseInsensitive)) {
+                if(isbstc || !line.contains("0 Error",Qt::CaseInsensitive))
+                    procResultError = true;
             }
-            else
-            if(line.contains("remaining",Qt::CaseInsensitive)) {
+            line.replace("longs", "bytes");
+        }
+
+        if(line.contains("Propeller Version",Qt::CaseInsensitive)) {
+            text += line+eol;
+            progress->setValue(0);
+        }
+        else
+        if(line.contains("loading",Qt::CaseInsensitive) && !(isbstc || isbasic)) {
+            progMax = 0;
+            progress->setValue(0);
+            text += line+eol;
+        }
+        else
+        if(line.contains("writing",Qt::CaseInsensitive)) {
+            progMax = 0;
+            progress->setValue(0);
+        }
+        else
+        if(line.contains("Download OK",Qt::CaseInsensitive)) {
+            progress->setValue(100);
+            text += line+eol;
+        }
+        else
+        if(line.contains("sent",Qt::CaseInsensitive)) {
+            text += line+eol;
+        }
+        else
+        if(line.contains("remaining",Qt::CaseInsensitive)) {
+            if(progMax == 0) {
+                QString bs = line.mid(0,line.indexOf(" "));
+                progMax = bs.toInt();
+                progMax /= 1024;
+                progMax++;
+                progCount = 0;
                 if(progMax == 0) {
-                    QString bs = line.mid(0,line.indexOf(" "));
-                    progMax = bs.toInt();
-                    progMax /= 1024;
-                    progMax++;
-                    progCount = 0;
-                    if(progMax == 0) {
-                        progress->setValue(100);
-                    }
+                    progress->setValue(100);
                 }
-                if(progMax != 0) {
-                    progCount++;
-                    progress->setValue(100*progCount/progMax);
-                }
-                compileStatus->moveCursor(QTextCursor::StartOfLine,QTextCursor::KeepAnchor);
-                compileStatus->insertPlainText(line);
             }
-            else
-            if(line.contains("Program size",Qt::CaseInsensitive)) {
-                // bstc reports program size is N longs
-                compileStatus->insertPlainText(eol);
-                compileStatus->insertPlainText(line);
-                QString s = line.mid(line.lastIndexOf("is ")+3);
-                s = s.mid(0,s.lastIndexOf(" "));
-                bool ok = false;
-                int size =  s.toInt(&ok);
-                this->codeSize = ok ? size : 0;
+            if(progMax != 0) {
+                progCount++;
+                progress->setValue(100*progCount/progMax);
             }
-            else {
-                if(n < lines.length())
-                    compileStatus->insertPlainText(eol);
-                compileStatus->insertPlainText(line);
+            /* progress overwrites the current line, so flush first */
+            if(text.length() > 0) {
+                insertStatus(text);
+                text.clear();
             }
+            compileStatus->moveCursor(QTextCursor::End);
+            compileStatus->moveCursor(QTextCursor::StartOfLine,QTextCursor::KeepAnchor);
+            compileStatus->insertPlainText(line);
+        }
+        else
+        if(line.contains("Program size",Qt::CaseInsensitive)) {
+            // bstc reports program size is N longs
+            text += eol+line;
+            QString s = line.mid(line.lastIndexOf("is ")+3);
+            s = s.mid(0,s.lastIndexOf(" "));
+            bool ok = false;
+            int size =  s.toInt(&ok);
+            this->codeSize = ok ? size : 0;
+        }
+        else {
+            text += eol+line;
         }
     }
 
+    if(text.length() > 0)
+        insertStatus(text);
 }
 
 int  Build::checkBuildStart(QProcess *proc, QString progName)
@@ -415,10 +518,7 @@ void Build::showBuildStart(QString progName, QStringList args)
     qDebug() << progName+argstr;
     compileStatus->appendPlainText(shortFileName(progName)+argstr);
 
-    while(blinker->isRunning()) {
-        QApplication::processEvents();
-        Sleeper::ms(50);
-    }
+    ToolRunner::waitThread(blinker);
     statusNone();
 }
 
@@ -450,30 +550,13 @@ int  Build::buildResult(int exitStatus, int exitCode, QString progName, QString
     }
     else if(exitCode != 0)
     {
-        if(compileStatus->toPlainText().contains("error")) {
-            /* try to add something reasonable without growing the screensize too much */
-            QString errstr;
-            QStringList list = compileStatus->toPlainText().split("\n");
-            for(int n = list.length()-1; n > -1; n--) {
-                QString str = list[n];
-                QRegExp re("\\b:\\d+:\\d.*error\\b", Qt::CaseInsensitive);
-                if(QString(str).contains(re)) {
-                    QStringList sa = str.split(re, QString::SkipEmptyParts);
-                    if(sa.length() > 1) {
-                        QDir dir(sourcePath(str));
-                        if(dir.exists()) {
-                            /*
-                             * show short filename and error only
-                             * even relative paths can be too long.
-                             */
-                            errstr = shortFileName(sa[0]) + " Error: "+sa[1];
-                        }
-                    }
-                    else {
-                        errstr = list[n];
-                    }
-                }
-            }
+        const BuildOutput::Diagnostic *diag = buildOutput.lastError();
+        if(diag != NULL) {
+            /*
+             * show short filename and error only
+             * even relative paths can be too long.
+             */
+            QString errstr = shortFileName(diag->file) + " Error: "+diag->message;
             status->setText(status->text()+" "+errstr+". ");
         }
         else {
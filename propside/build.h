@@ -21,6 +21,8 @@
 #define BUILD_H
 
 #include "blinker.h"
+#include "buildjobs.h"
+#include "buildoutput.h"
 #include "properties.h"
 #include "projectoptions.h"
 
@@ -43,6 +45,7 @@ public:
 
     enum DumpType { DumpNormal, DumpReadSizes, DumpCat, DumpOff };
     int  startProgram(QString program, QString workpath, QStringList args, DumpType dump = DumpOff);
+    int  startPrograms(QString program, QString workpath, QList<QStringList> argsList, QList<int> *results = 0);
 
 public slots:
     void procError(QProcess::ProcessError error);
@@ -50,6 +53,7 @@ public slots:
     void procReadyReadCat();
     void procReadyRead();
     void procReadyReadSizes();
+    void buildJobFinished(int n);
 
     void statusNone();
     void statusFailed();
@@ -68,6 +72,8 @@ public:
     QString shortFileName(QString fileName);
     void removeArg(QStringList &list, QString arg);
 
+    const BuildOutput &output() { return buildOutput; }
+
     void clearIncludeHash() {
         if(incHash.count() > 0)
             incHash.clear();
@@ -77,6 +83,10 @@ signals:
     void showCompileStatusError();
 
 private:
+    void flushOutput(DumpType dump);
+    void insertStatus(const QString &text);
+    void addSizesLine(const QString &line);
+
     Blinker *blinker;
 
 protected:
@@ -92,6 +102,7 @@ protected:
     QComboBox       *cbBoard;
 
     QProcess        *process;
+    BuildJobs       *buildJobs;
     int             codeSize;
     int             memorySize;
 
@@ -106,6 +117,11 @@ protected:
 
     QString         outputFile;
 
+    BuildOutput     buildOutput;
+    BuildOutput     sizesOutput;
+    int             sizesPending;
+    bool            sizesDone;
+
     QHash<QString, QString> incHash;
     QHash<QString, QString> filesHash;
 };
@@ -29,6 +29,7 @@
 BuildC::BuildC(ProjectOptions *projopts, QPlainTextEdit *compstat, QLabel *stat, QLabel *progsize, QProgressBar *progbar, QComboBox *cb, Properties *p)
     : Build(projopts, compstat, stat, progsize, progbar, cb, p)
 {
+    libIndex = LibraryIndex::shared();
 }
 
 int  BuildC::runBuild(QString option, QString projfile, QString compiler)
@@ -85,6 +86,7 @@ int  BuildC::runBuild(QString option, QString projfile, QString compiler)
     programSize->setText("");
 
     compileStatus->setPlainText(tr("Project Directory: ")+sourcePath(projectFile)+"\n");
+    buildOutput.clear();
     compileStatus->moveCursor(QTextCursor::End);
 
     QString version = QString("%1 Version %2.%3.%4").arg(ASideGuiKey)
@@ -163,21 +165,9 @@ int  BuildC::runBuild(QString option, QString projfile, QString compiler)
             eecog = true;
         */
 
-        /* remove a.out before build
+        /* the .elf is removed just before linking, see removeOutputFile().
+         * an up to date .elf is kept when the link can be skipped.
          */
-        QFile aout(exePath);
-        if(aout.exists()) {
-            if(aout.remove() == false) {
-                rc = QMessageBox::question(0,
-                    tr("Can't Remove File"),
-                    tr("Can't Remove output file before build.\n"\
-                       "Please close any program using the file \"") + exeName + tr("\".\n"\
-                       "Continue?"),
-                    QMessageBox::No, QMessageBox::Yes);
-                if(rc == QMessageBox::No)
-                    return -1;
-            }
-        }
 
         /* remove projectFile.pex before build
          */
@@ -431,6 +421,27 @@ int  BuildC::runBuild(QString option, QString projfile, QString compiler)
     return rc;
 }
 
+/*
+ * remove a.out before linking
+ */
+int  BuildC::removeOutputFile()
+{
+    QFile aout(exePath);
+    if(aout.exists()) {
+        if(aout.remove() == false) {
+            int rc = QMessageBox::question(0,
+                tr("Can't Remove File"),
+                tr("Can't Remove output file before build.\n"\
+                   "Please close any program using the file \"") + exeName + tr("\".\n"\
+                   "Continue?"),
+                QMessageBox::No, QMessageBox::Yes);
+            if(rc == QMessageBox::No)
+                return -1;
+        }
+    }
+    return 0;
+}
+
 int  BuildC::showCompilerVersion()
 {
     int rc = 0;
@@ -770,8 +781,20 @@ int  BuildC::runCompiler(QStringList copts)
         compstr+="c++";
     }
 
+    /* the build database lives next to the objects it describes
+     * and the tool id makes a compiler update rebuild everything.
+     */
+    QString workpath = sourcePath(projectFile);
+    QString libbase = projName.mid(0, projName.lastIndexOf("."));
+    buildCache.load(workpath+outputPath+libbase+BUILDCACHE_EXTENSION);
+    QString toolId = compstr+" "+QFileInfo(aSideCompiler).lastModified().toString(Qt::ISODate);
+
     /* this is intermediate compile */
     QStringList tlist;
+    QList<QStringList> compileJobs;
+    QStringList compileTargets;
+    QStringList compileSources;
+    QStringList compileFlags;
     int inc = 0;
     int lib = 0;
     QStringList libs;
@@ -929,26 +952,49 @@ int  BuildC::runCompiler(QStringList copts)
         else if(s.compare(".") != 0) {
             if(!tlist.contains("-c"))
                 tlist.append("-c");
-            tlist.append(s);
             args.removeOne(s);
             QString objPath = outputPath + shortFileName(s);
             objPath = objPath.replace(".c", ".o");
             args.append(objPath);
-            tlist.append("-o");
-            tlist.append(objPath);
-            rc = startProgram(compstr,sourcePath(projectFile),tlist);
-            tlist.removeLast(); // objPath
-            tlist.removeLast(); // "-o"
-            tlist.removeLast(); // srcFile
-            if(rc != 0)
-                return rc;
+            /* only compile translation units whose source, headers, or flags changed */
+            QString flags = toolId+" "+tlist.join(" ")+" "+s;
+            if(buildCache.isCurrent(objPath, flags, workpath) == false) {
+                QStringList job = tlist;
+                job.append("-MMD");
+                job.append("-MF");
+                job.append(BuildCache::dependFile(objPath));
+                job.append(s);
+                job.append("-o");
+                job.append(objPath);
+                compileJobs.append(job);
+                compileTargets.append(objPath);
+                compileSources.append(s);
+                compileFlags.append(flags);
+            }
         }
         progress->setValue((100*prog++)/maxprogress);
     }
 
+    /* the -c compiles are independent of each other, run them concurrently
+     * and only continue to the archive and link once all objects are done.
+     */
+    if(compileJobs.count() > 0) {
+        QList<int> results;
+        rc = startPrograms(compstr,sourcePath(projectFile),compileJobs,&results);
+        for(int n = 0; n < compileTargets.count(); n++) {
+            if(n < results.count() && results[n] == 0)
+                buildCache.update(compileTargets[n], compileFlags[n], workpath,
+                                  QStringList(compileSources[n]), BuildCache::dependFile(compileTargets[n]));
+            else
+                buildCache.remove(compileTargets[n]);
+        }
+        buildCache.save();
+        if(rc != 0)
+            return rc;
+    }
+
     /* let's make a library after compiling the program so we can use .o from save-temps
      */
-    QString libbase = projName.mid(0, projName.lastIndexOf("."));
     QString libname = outputPath + libbase + ".a";
     if(projectOptions->getMakeLibrary().isEmpty() != true)
     {
@@ -973,7 +1019,13 @@ int  BuildC::runCompiler(QStringList copts)
              }
         }
 
-        this->runAR(objs, libname);
+        QString arflags = "ar "+objs.join(" ");
+        if(buildCache.isCurrent(libname, arflags, workpath) == false) {
+            if(this->runAR(objs, libname) == 0)
+                buildCache.update(libname, arflags, workpath, objs);
+            else
+                buildCache.remove(libname);
+        }
         progress->setValue((100*prog++)/maxprogress);
     }
 
@@ -1016,8 +1068,29 @@ int  BuildC::runCompiler(QStringList copts)
         libs.removeAt(m-1); // optimize library add
     }
 
-    // this is the final compile/link
-    rc = startProgram(compstr,sourcePath(projectFile),args);
+    // this is the final compile/link, skipped if no input or flag changed
+    QString linkflags = toolId+" "+args.join(" ");
+    if(buildCache.isCurrent(exePath, linkflags, workpath)) {
+        compileStatus->appendPlainText(tr("Link skipped:")+" "+exeName+" "+tr("is up to date."));
+        rc = 0;
+    }
+    else {
+        if(removeOutputFile() != 0) {
+            buildCache.save();
+            return -1;
+        }
+        QString depfile = BuildCache::dependFile(exePath);
+        QStringList largs = args;
+        largs.append("-MMD");
+        largs.append("-MF");
+        largs.append(depfile);
+        rc = startProgram(compstr,sourcePath(projectFile),largs);
+        if(rc == 0)
+            buildCache.update(exePath, linkflags, workpath, getLinkInputs(args, workpath), depfile);
+        else
+            buildCache.remove(exePath);
+    }
+    buildCache.save();
     progress->setValue((100*prog++)/maxprogress);
     if(rc != 0)
         return rc;
@@ -1185,6 +1258,7 @@ int BuildC::makeDebugFiles(QString fileName, QString projfile, QString compiler)
 
     /* this is the final compile/link */
     compileStatus->setPlainText("");
+    buildOutput.clear();
     int rc = startProgram(compstr,sourcePath(projectFile),args);
     if(rc) {
         QMessageBox mbox(QMessageBox::Critical, tr("Compile Error"),
@@ -1478,6 +1552,51 @@ bool BuildC::isOutdated(QStringList srclist, QString srcpath, QString target)
     return false;
 }
 
+/*
+ * Files a link reads: the main source, objects, archives, and
+ * any -lname archive found in a -L directory of the project.
+ */
+QStringList BuildC::getLinkInputs(QStringList args, QString workpath)
+{
+    QStringList inputs;
+    QStringList libdirs;
+    QStringList libnames;
+    QDir dir(workpath);
+
+    for(int n = 0; n < args.count(); n++) {
+        QString s = args.at(n);
+        if(s.compare("-o") == 0) {
+            n++; // skip the target
+        }
+        else if(s.compare("-L") == 0) {
+            if(n+1 < args.count())
+                libdirs.append(args.at(++n));
+        }
+        else if(s.indexOf("-L") == 0) {
+            libdirs.append(s.mid(2));
+        }
+        else if(s.indexOf("-l") == 0) {
+            if(libnames.contains(s.mid(2)) == false)
+                libnames.append(s.mid(2));
+        }
+        else if(s.indexOf("-") != 0) {
+            if(QFileInfo(dir, s).isFile())
+                inputs.append(s);
+        }
+    }
+
+    foreach(QString name, libnames) {
+        foreach(QString libdir, libdirs) {
+            QString lib = QDir(dir.absoluteFilePath(libdir)).absoluteFilePath("lib"+name+".a");
+            if(QFile::exists(lib)) {
+                inputs.append(lib);
+                break;
+            }
+        }
+    }
+    return inputs;
+}
+
 QStringList BuildC::getLocalSourceList(QStringList &LLlist)
 {
     QStringList list;
@@ -1546,6 +1665,9 @@ QStringList BuildC::getLibraryList(QStringList &ILlist, QString projFile)
     /* invalidate cache each time we build */
     filesHash.clear();
 
+    /* bring the library index up to date, one stat per folder at most every few seconds */
+    libIndex->open(libdir);
+
     foreach(QString srcFile, srcList) {
         autoAddLib(projectPath, srcFile, libdir, ilist, &newList);
     }
@@ -1557,22 +1679,16 @@ QStringList BuildC::getLibraryList(QStringList &ILlist, QString projFile)
 int  BuildC::autoAddLib(QString projectPath, QString srcFile, QString libdir, QStringList incList, QStringList *newList)
 {
     QApplication::processEvents();
-    QString include("#include ");
 
     QString includedStr = projectPath+"/"+srcFile;
     if(filesHash.contains(includedStr)) return newList->count();
 
-    QStringList findlist = Directory::findCSourceList(projectPath+"/"+srcFile, include);
+    /* include names are cached by file time, so shared headers are scanned once */
+    QStringList findlist = Directory::findCIncludes(includedStr);
     filesHash[includedStr] = includedStr;
 
     foreach(QString inc, findlist) {
         QApplication::processEvents();
-        inc = inc.mid(inc.indexOf(include)+include.length());
-        inc = inc.trimmed();
-        //if(inc.at(0) == '<') continue;
-        //if(inc.endsWith('>'))continue;
-        if(inc.at(0) == '"' || inc.at(0) == '<') inc = inc.mid(1);
-        if(inc.endsWith('"') || inc.at(0) == '>')inc = inc.left(inc.count()-1);
         inc = inc.trimmed();
         inc = "lib"+inc;
         inc = inc.mid(0,inc.indexOf(".h"));
@@ -1636,20 +1752,22 @@ QString BuildC::findInclude(QString projdir, QString libdir, QString include)
 
 /*
  * find and cache the include path.
+ * library folders are looked up in the library index instead of walking them.
  */
 QString BuildC::findIncludePath(QString projdir, QString libdir, QString include)
 {
     QString s;
     // look in project first
-    s = Directory::recursiveFindFile(projdir, include);
+    s = libIndex->findFile(projdir, include);
     if(s.length() > 0) {
         incHash.insert(include, s);
         return s;
     }
     // if we get here, not project code was found - look in global library
-    s = Directory::recursiveFindFile(libdir,include);
+    if(libIndex->rootPath().isEmpty())
+        libIndex->open(libdir);
+    s = libIndex->findFile(libdir, include);
     if(s.length() > 0) {
-        s = Directory::recursiveFindFile(libdir, include);
         incHash.insert(include, s);
         return s;
     }
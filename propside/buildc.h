@@ -21,6 +21,8 @@
 #define BUILDC_H
 
 #include "build.h"
+#include "buildcache.h"
+#include "libraryindex.h"
 
 class BuildC : public Build
 {
@@ -55,11 +57,13 @@ public:
 
     bool isOutdated(QStringList srclist, QString srcpath, QString target);
     QStringList getLocalSourceList(QStringList &LLlist);
+    QStringList getLinkInputs(QStringList args, QString workpath);
     QStringList getLibraryList(QStringList &ILlist, QString projectFile);
     QString findInclude(QString projdir, QString libdir, QString include);
 
 private:
     QString findIncludePath(QString projdir, QString libdir, QString include);
+    int  removeOutputFile();
 
 private:
     QString projName;
@@ -68,6 +72,9 @@ private:
     QString exePath;
     QString exeName;
     QString memModel;
+
+    BuildCache buildCache;
+    LibraryIndex *libIndex;
 };
 
 #endif // BUILDC_H
@@ -0,0 +1,251 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "buildcache.h"
+
+#define BUILDCACHE_MAGIC    0x53424442  // "SBDB"
+#define BUILDCACHE_VERSION  1
+
+BuildCache::BuildCache()
+{
+    dirty = false;
+}
+
+/*
+ * Load the database. A missing or unreadable file just means
+ * everything gets built once and the database is created on save.
+ * File hashes are only remembered for the duration of one build.
+ */
+bool BuildCache::load(QString dbfile)
+{
+    dbFile = dbfile;
+    dirty = false;
+    entries.clear();
+    hashes.clear();
+
+    QFile file(dbFile);
+    if(!file.open(QFile::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    quint32 magic = 0;
+    qint32 version = 0;
+    in >> magic >> version;
+    if(magic != BUILDCACHE_MAGIC || version != BUILDCACHE_VERSION) {
+        file.close();
+        return false;
+    }
+
+    qint32 count = 0;
+    in >> count;
+    for(int n = 0; n < count && in.status() == QDataStream::Ok; n++) {
+        QString target;
+        Entry entry;
+        in >> target >> entry.flagsHash >> entry.targetHash >> entry.depends;
+        entries.insert(target, entry);
+    }
+    file.close();
+
+    if(in.status() != QDataStream::Ok) {
+        entries.clear();
+        return false;
+    }
+    return true;
+}
+
+bool BuildCache::save()
+{
+    if(!dirty || dbFile.isEmpty())
+        return true;
+
+    QFile file(dbFile);
+    if(!file.open(QFile::WriteOnly | QFile::Truncate))
+        return false;
+
+    QDataStream out(&file);
+    out << (quint32) BUILDCACHE_MAGIC << (qint32) BUILDCACHE_VERSION;
+    out << (qint32) entries.count();
+    QHash<QString, Entry>::const_iterator it;
+    for(it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        out << it.key() << it.value().flagsHash << it.value().targetHash << it.value().depends;
+    }
+    file.close();
+    dirty = false;
+    return true;
+}
+
+void BuildCache::clear()
+{
+    entries.clear();
+    hashes.clear();
+    dirty = true;
+}
+
+/*
+ * True if target exists unchanged since it was last recorded,
+ * it was made with the same flags, and none of its inputs changed.
+ */
+bool BuildCache::isCurrent(QString target, QString flags, QString workpath)
+{
+    if(!entries.contains(target))
+        return false;
+
+    const Entry &entry = entries[target];
+    if(entry.flagsHash != QCryptographicHash::hash(flags.toUtf8(), QCryptographicHash::Md5))
+        return false;
+
+    QByteArray thash = fileHash(absolutePath(workpath, target));
+    if(thash.isEmpty() || thash != entry.targetHash)
+        return false;
+
+    QHash<QString, QByteArray>::const_iterator it;
+    for(it = entry.depends.constBegin(); it != entry.depends.constEnd(); ++it) {
+        if(fileHash(absolutePath(workpath, it.key())) != it.value())
+            return false;
+    }
+    return true;
+}
+
+/*
+ * Record a freshly built target. inputs are files given on the command line,
+ * depfile is the gcc -MMD output listing the source and headers it used.
+ */
+void BuildCache::update(QString target, QString flags, QString workpath, QStringList inputs, QString depfile)
+{
+    Entry entry;
+    entry.flagsHash = QCryptographicHash::hash(flags.toUtf8(), QCryptographicHash::Md5);
+
+    /* the target was just written, don't trust a hash from before the build */
+    QString tpath = absolutePath(workpath, target);
+    hashes.remove(tpath);
+    entry.targetHash = fileHash(tpath);
+    if(entry.targetHash.isEmpty()) {
+        remove(target);
+        return;
+    }
+
+    if(depfile.length() > 0)
+        inputs.append(readDependFile(absolutePath(workpath, depfile)));
+
+    foreach(QString input, inputs) {
+        if(input.isEmpty() || entry.depends.contains(input))
+            continue;
+        entry.depends.insert(input, fileHash(absolutePath(workpath, input)));
+    }
+
+    entries.insert(target, entry);
+    dirty = true;
+}
+
+void BuildCache::remove(QString target)
+{
+    if(entries.remove(target) > 0)
+        dirty = true;
+}
+
+/*
+ * Name of the gcc -MF file for a target: lmm/foo.o -> lmm/foo.d
+ */
+QString BuildCache::dependFile(QString target)
+{
+    int dot = target.lastIndexOf(".");
+    if(dot > target.lastIndexOf("/"))
+        target = target.left(dot);
+    return target+".d";
+}
+
+/*
+ * Parse a make rule written by gcc -MMD.
+ * Continuation lines are joined and "\ " is an escaped space in a path.
+ */
+QStringList BuildCache::readDependFile(QString depfile)
+{
+    QStringList list;
+    QFile file(depfile);
+    if(!file.open(QFile::ReadOnly | QFile::Text))
+        return list;
+    QString rule = QString::fromLocal8Bit(file.readAll());
+    file.close();
+
+    rule.replace("\\\n", " ");
+
+    /* skip the target, it may contain a drive letter colon */
+    int colon = -1;
+    for(int n = 0; n < rule.length()-1; n++) {
+        if(rule[n] == ':' && rule[n+1].isSpace()) {
+            colon = n;
+            break;
+        }
+    }
+    if(colon < 0)
+        return list;
+
+    QString name;
+    int len = rule.indexOf("\n", colon);
+    if(len < 0)
+        len = rule.length();
+    for(int n = colon+1; n < len; n++) {
+        QChar ch = rule[n];
+        if(ch == '\\' && n+1 < len && rule[n+1] == ' ') {
+            name += ' ';
+            n++;
+        }
+        else if(ch.isSpace()) {
+            if(name.length() > 0)
+                list.append(name);
+            name = "";
+        }
+        else {
+            name += ch;
+        }
+    }
+    if(name.length() > 0)
+        list.append(name);
+    return list;
+}
+
+QString BuildCache::absolutePath(QString workpath, QString file)
+{
+    if(QDir::isAbsolutePath(file))
+        return file;
+    return QDir(workpath).absoluteFilePath(file);
+}
+
+/*
+ * MD5 of a file's contents, remembered so headers shared by many
+ * sources are only read once per build. Empty if the file is missing.
+ */
+QByteArray BuildCache::fileHash(QString path)
+{
+    if(hashes.contains(path))
+        return hashes[path];
+
+    QByteArray hash;
+    QFile file(path);
+    if(file.open(QFile::ReadOnly)) {
+        QCryptographicHash md5(QCryptographicHash::Md5);
+        while(!file.atEnd()) {
+            md5.addData(file.read(64*1024));
+        }
+        file.close();
+        hash = md5.result();
+    }
+    hashes.insert(path, hash);
+    return hash;
+}
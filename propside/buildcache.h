@@ -0,0 +1,70 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BUILDCACHE_H
+#define BUILDCACHE_H
+
+#include "qtversion.h"
+
+#define BUILDCACHE_EXTENSION ".builddb"
+
+/*
+ * BuildCache is the per-project build database kept in the memory model
+ * output directory. For every target (object or .elf) it records a hash of
+ * the command line flags, of the target itself, and of every input the
+ * target was made from: the source, the headers reported by gcc -MMD,
+ * and for links the objects and libraries.
+ *
+ * A target is current only if all of those hashes still match, so an
+ * untouched translation unit is never recompiled and a link is skipped
+ * when none of its inputs changed.
+ */
+class BuildCache
+{
+public:
+    BuildCache();
+
+    bool load(QString dbfile);
+    bool save();
+    void clear();
+
+    bool isCurrent(QString target, QString flags, QString workpath);
+    void update(QString target, QString flags, QString workpath, QStringList inputs, QString depfile = "");
+    void remove(QString target);
+
+    static QString dependFile(QString target);
+    static QStringList readDependFile(QString depfile);
+
+private:
+    QString absolutePath(QString workpath, QString file);
+    QByteArray fileHash(QString path);
+
+    struct Entry {
+        QByteArray flagsHash;
+        QByteArray targetHash;
+        QHash<QString, QByteArray> depends;
+    };
+
+    QString dbFile;
+    bool    dirty;
+    QHash<QString, Entry> entries;
+    QHash<QString, QByteArray> hashes;
+};
+
+#endif // BUILDCACHE_H
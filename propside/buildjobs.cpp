@@ -0,0 +1,173 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "buildjobs.h"
+
+BuildJobs::BuildJobs(int maxJobs, QObject *parent) : QObject(parent)
+{
+    jobSlots = maxJobs > 0 ? maxJobs : 1;
+    nextJob = 0;
+    doneCount = 0;
+    failed = false;
+    aborted = false;
+}
+
+BuildJobs::~BuildJobs()
+{
+    foreach(QProcess *proc, running.keys()) {
+        proc->disconnect(this);
+        proc->kill();
+        proc->waitForFinished(1000);
+        delete proc;
+    }
+    running.clear();
+}
+
+/*
+ * Number of concurrent compiles to use when the user has not chosen one.
+ */
+int BuildJobs::defaultJobs()
+{
+    int n = QThread::idealThreadCount();
+    return n > 0 ? n : 1;
+}
+
+int BuildJobs::addJob(QString program, QString workpath, QStringList args)
+{
+    Job job;
+    job.program = program;
+    job.workpath = workpath;
+    job.args = args;
+    job.exitCode = 0;
+    job.exitStatus = QProcess::NormalExit;
+    job.failed = false;
+    job.done = false;
+    jobs.append(job);
+    return jobs.count()-1;
+}
+
+/*
+ * Run all jobs and return when every started job has finished.
+ * After the first failure no new jobs are started, but jobs already
+ * running are allowed to finish so their messages can be reported.
+ * Returns 0 if all jobs passed.
+ */
+int BuildJobs::run()
+{
+    nextJob = 0;
+    doneCount = 0;
+    failed = false;
+    aborted = false;
+
+    for(int n = 0; n < jobSlots; n++) {
+        if(!startNext())
+            break;
+    }
+
+    if(running.count() > 0)
+        loop.exec();
+
+    if(aborted)
+        return -1;
+    return failed ? 1 : 0;
+}
+
+void BuildJobs::abort()
+{
+    aborted = true;
+    failed = true;
+    foreach(QProcess *proc, running.keys()) {
+        proc->kill();
+    }
+}
+
+bool BuildJobs::startNext()
+{
+    if(failed || nextJob >= jobs.count())
+        return false;
+
+    int n = nextJob++;
+    QProcess *proc = new QProcess();
+    proc->setProcessChannelMode(QProcess::MergedChannels);
+    proc->setWorkingDirectory(jobs[n].workpath);
+    running.insert(proc, n);
+
+    connect(proc, SIGNAL(readyReadStandardOutput()), this, SLOT(procReadyRead()));
+    connect(proc, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(procFinished(int,QProcess::ExitStatus)));
+    connect(proc, SIGNAL(error(QProcess::ProcessError)), this, SLOT(procError(QProcess::ProcessError)));
+
+    emit jobStarted(n);
+    proc->start(jobs[n].program, jobs[n].args);
+    return true;
+}
+
+void BuildJobs::procReadyRead()
+{
+    QProcess *proc = qobject_cast<QProcess*>(sender());
+    if(proc == 0 || !running.contains(proc))
+        return;
+    jobs[running[proc]].output.append(proc->readAllStandardOutput());
+}
+
+void BuildJobs::procFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    QProcess *proc = qobject_cast<QProcess*>(sender());
+    if(proc == 0 || !running.contains(proc))
+        return;
+    Job &job = jobs[running[proc]];
+    job.exitCode = exitCode;
+    job.exitStatus = exitStatus;
+    job.failed = (exitStatus == QProcess::CrashExit || exitCode != 0);
+    finishJob(proc);
+}
+
+void BuildJobs::procError(QProcess::ProcessError error)
+{
+    QProcess *proc = qobject_cast<QProcess*>(sender());
+    if(proc == 0 || !running.contains(proc))
+        return;
+    /* a crash also delivers finished(), let that path report it */
+    if(error != QProcess::FailedToStart)
+        return;
+    Job &job = jobs[running[proc]];
+    job.output.append(QString(job.program+tr(" error ... (%1)").arg(error)).toLocal8Bit());
+    job.exitCode = -1;
+    job.exitStatus = QProcess::CrashExit;
+    job.failed = true;
+    finishJob(proc);
+}
+
+void BuildJobs::finishJob(QProcess *proc)
+{
+    int n = running.take(proc);
+    jobs[n].output.append(proc->readAllStandardOutput());
+    proc->disconnect(this);
+    proc->deleteLater();
+
+    doneCount++;
+    jobs[n].done = true;
+    if(jobs[n].failed)
+        failed = true;
+
+    emit jobFinished(n);
+
+    startNext();
+    if(running.count() == 0)
+        loop.quit();
+}
@@ -0,0 +1,90 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BUILDJOBS_H
+#define BUILDJOBS_H
+
+#include "qtversion.h"
+
+/*
+ * BuildJobs runs a list of independent tool invocations (usually gcc -c)
+ * with up to maxJobs QProcess instances alive at once.
+ * Output is collected per job so messages from different compiles
+ * never interleave; the owner prints each job when jobFinished fires.
+ */
+class BuildJobs : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BuildJobs(int maxJobs, QObject *parent = 0);
+    virtual ~BuildJobs();
+
+    int  addJob(QString program, QString workpath, QStringList args);
+    int  run();
+    void abort();
+
+    int  count()                { return jobs.count(); }
+    int  maxJobs()              { return jobSlots; }
+    bool isAborted()            { return aborted; }
+
+    QString     jobProgram(int n)   { return jobs.at(n).program; }
+    QStringList jobArgs(int n)      { return jobs.at(n).args; }
+    QByteArray  jobOutput(int n)    { return jobs.at(n).output; }
+    int         jobExitCode(int n)  { return jobs.at(n).exitCode; }
+    int         jobExitStatus(int n){ return jobs.at(n).exitStatus; }
+    bool        jobFailed(int n)    { return jobs.at(n).failed; }
+    bool        jobRan(int n)       { return jobs.at(n).done; }
+
+    static int  defaultJobs();
+
+signals:
+    void jobStarted(int n);
+    void jobFinished(int n);
+
+private slots:
+    void procReadyRead();
+    void procFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void procError(QProcess::ProcessError error);
+
+private:
+    bool startNext();
+    void finishJob(QProcess *proc);
+
+    struct Job {
+        QString     program;
+        QString     workpath;
+        QStringList args;
+        QByteArray  output;
+        int         exitCode;
+        int         exitStatus;
+        bool        failed;
+        bool        done;
+    };
+
+    QList<Job>  jobs;
+    QHash<QProcess*, int> running;
+    QEventLoop  loop;
+    int         jobSlots;
+    int         nextJob;
+    int         doneCount;
+    bool        failed;
+    bool        aborted;
+};
+
+#endif // BUILDJOBS_H
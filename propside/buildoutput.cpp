@@ -0,0 +1,228 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "buildoutput.h"
+
+BuildOutput::BuildOutput()
+{
+    errors = 0;
+    warnings = 0;
+}
+
+/*
+ * Forget diagnostics and any unfinished line. Called once per build.
+ */
+void BuildOutput::clear()
+{
+    partial.clear();
+    diagList.clear();
+    blockIndex.clear();
+    errors = 0;
+    warnings = 0;
+}
+
+/*
+ * Drop an unfinished line left by a previous process.
+ */
+void BuildOutput::startStream()
+{
+    partial.clear();
+}
+
+QStringList BuildOutput::addBytes(const QByteArray &bytes)
+{
+    QStringList lines;
+    partial.append(bytes);
+
+    const char *data = partial.constData();
+    int len = partial.length();
+    int start = 0;
+    for(int n = 0; n < len; n++) {
+        char c = data[n];
+        if(c != '\n' && c != '\r')
+            continue;
+        /* a CR at the end may be the first half of a CRLF */
+        if(c == '\r' && n+1 == len)
+            break;
+        if(n > start)
+            lines.append(QString::fromLocal8Bit(data+start, n-start));
+        if(c == '\r' && data[n+1] == '\n')
+            n++;
+        start = n+1;
+    }
+    partial = partial.mid(start);
+    return lines;
+}
+
+/*
+ * Return the unfinished line, if any, once the process is done.
+ */
+QString BuildOutput::flush()
+{
+    QByteArray rest = partial;
+    partial.clear();
+    while(rest.endsWith('\r'))
+        rest.chop(1);
+    return QString::fromLocal8Bit(rest.constData(), rest.length());
+}
+
+/*
+ * Keep line if it is a diagnostic. Returns true if it was one.
+ * A block that was seen before is classified again in place.
+ */
+bool BuildOutput::addLine(const QString &line, int block)
+{
+    Diagnostic diag;
+    if(!parseLine(line, diag))
+        return false;
+    diag.text = line;
+    diag.block = block;
+
+    if(block > -1 && blockIndex.contains(block)) {
+        Diagnostic &old = diagList[blockIndex[block]];
+        if(old.severity == Error)
+            errors--;
+        else if(old.severity == Warning)
+            warnings--;
+        old = diag;
+    }
+    else {
+        if(block > -1)
+            blockIndex.insert(block, diagList.count());
+        diagList.append(diag);
+    }
+
+    if(diag.severity == Error)
+        errors++;
+    else if(diag.severity == Warning)
+        warnings++;
+    return true;
+}
+
+/*
+ * Classify status blocks from first to the end of the document.
+ * The first block may be a line that was already classified.
+ */
+void BuildOutput::addBlocks(const QTextDocument *doc, int first)
+{
+    QTextBlock block = doc->findBlockByNumber(first);
+    while(block.isValid()) {
+        QString text = block.text();
+        if(text.length() > 0)
+            addLine(text, block.blockNumber());
+        block = block.next();
+    }
+}
+
+/*
+ * Index of the diagnostic shown in block, or -1. The block text is
+ * compared so a status pane cleared by someone else can't give a
+ * stale answer.
+ */
+int BuildOutput::diagnosticAt(const QTextDocument *doc, int block) const
+{
+    if(blockIndex.contains(block) == false)
+        return -1;
+    int index = blockIndex[block];
+    if(doc->findBlockByNumber(block).text() != diagList[index].text)
+        return -1;
+    return index;
+}
+
+/*
+ * Next error or warning after index, or before it if forward is false.
+ * Wraps around. Pass -1 to start from either end.
+ */
+int BuildOutput::nextDiagnostic(int index, bool forward) const
+{
+    int count = diagList.count();
+    if(count == 0)
+        return -1;
+    if(index < 0 || index >= count)
+        index = forward ? count-1 : 0;
+    for(int n = 1; n <= count; n++) {
+        int m = forward ? (index+n) % count : (index-n+count) % count;
+        if(diagList[m].severity != Note)
+            return m;
+    }
+    return -1;
+}
+
+/*
+ * Recognize gcc "file:line:column: error: message" (column is optional)
+ * and openspin/bstc "file(line:column) : error : message" lines.
+ * The expressions are shared, so this is for the GUI thread only.
+ */
+bool BuildOutput::parseLine(const QString &line, Diagnostic &diag)
+{
+    static QRegExp gccColumn("^(.+):(\\d+):(\\d+):\\s*(fatal error|error|warning|note):\\s*(.*)$", Qt::CaseInsensitive);
+    static QRegExp gccLine("^(.+):(\\d+):\\s*(fatal error|error|warning|note):\\s*(.*)$", Qt::CaseInsensitive);
+    static QRegExp spin("^(.+)\\((\\d+)[,:](\\d+)\\)\\s*:\\s*(error|warning)\\s*:?\\s*(.*)$", Qt::CaseInsensitive);
+
+    QString severity;
+    if(line.indexOf(':') < 0)
+        return false;
+
+    if(gccColumn.indexIn(line) > -1) {
+        diag.file = gccColumn.cap(1);
+        diag.line = gccColumn.cap(2).toInt();
+        diag.column = gccColumn.cap(3).toInt();
+        severity = gccColumn.cap(4);
+        diag.message = gccColumn.cap(5);
+    }
+    else if(gccLine.indexIn(line) > -1) {
+        diag.file = gccLine.cap(1);
+        diag.line = gccLine.cap(2).toInt();
+        diag.column = 0;
+        severity = gccLine.cap(3);
+        diag.message = gccLine.cap(4);
+    }
+    else if(spin.indexIn(line) > -1) {
+        diag.file = spin.cap(1);
+        diag.line = spin.cap(2).toInt();
+        diag.column = spin.cap(3).toInt();
+        severity = spin.cap(4);
+        diag.message = spin.cap(5);
+        /* long spin paths are shortened with ... */
+        if(diag.file.contains("..."))
+            diag.file = diag.file.mid(diag.file.indexOf("...")+3);
+    }
+    else {
+        return false;
+    }
+
+    diag.file = diag.file.trimmed();
+    severity = severity.toLower();
+    if(severity.contains("error"))
+        diag.severity = Error;
+    else if(severity.contains("warning"))
+        diag.severity = Warning;
+    else
+        diag.severity = Note;
+    return true;
+}
+
+const BuildOutput::Diagnostic *BuildOutput::lastError() const
+{
+    for(int n = diagList.count()-1; n > -1; n--) {
+        if(diagList[n].severity == Error)
+            return &diagList[n];
+    }
+    return NULL;
+}
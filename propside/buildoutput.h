@@ -0,0 +1,80 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BUILDOUTPUT_H
+#define BUILDOUTPUT_H
+
+#include "qtversion.h"
+
+/*
+ * BuildOutput turns tool output into lines as it arrives and keeps the
+ * compiler diagnostics found in them.
+ *
+ * addBytes() returns only complete lines. A line ends at LF, CRLF, or a
+ * bare CR so loader progress lines come out one at a time; an unfinished
+ * line waits for the next chunk or flush(). Each line is classified once
+ * by addLine(), so callers never have to search the status text again.
+ *
+ * addBlocks() classifies lines as they land in the status pane and
+ * remembers the block each diagnostic is shown in, so a click on the
+ * status pane is a hash lookup.
+ */
+class BuildOutput
+{
+public:
+    enum Severity { Note, Warning, Error };
+
+    struct Diagnostic {
+        QString     file;
+        int         line;
+        int         column;
+        Severity    severity;
+        QString     message;
+        QString     text;
+        int         block;
+    };
+
+    BuildOutput();
+
+    void clear();
+    void startStream();
+    QStringList addBytes(const QByteArray &bytes);
+    QString flush();
+
+    bool addLine(const QString &line, int block = -1);
+    void addBlocks(const QTextDocument *doc, int first);
+    static bool parseLine(const QString &line, Diagnostic &diag);
+
+    int diagnosticAt(const QTextDocument *doc, int block) const;
+    int nextDiagnostic(int index, bool forward) const;
+
+    const QList<Diagnostic> &diagnostics() const { return diagList; }
+    int errorCount() const { return errors; }
+    int warningCount() const { return warnings; }
+    const Diagnostic *lastError() const;
+
+private:
+    QByteArray          partial;
+    QList<Diagnostic>   diagList;
+    QHash<int, int>     blockIndex;
+    int                 errors;
+    int                 warnings;
+};
+
+#endif // BUILDOUTPUT_H
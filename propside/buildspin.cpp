@@ -52,6 +52,7 @@ int  BuildSpin::runBuild(QString option, QString projfile, QString compiler)
     programSize->setText("");
 
     compileStatus->setPlainText(tr("Project Directory: ")+sourcePath(projectFile)+"\r\n");
+    buildOutput.clear();
     compileStatus->moveCursor(QTextCursor::End);
     status->setText(tr("Building ...")+" "+spinfile);
 
@@ -0,0 +1,105 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "bytequeue.h"
+
+/*
+ * The size is rounded up to a power of two so indexes can run freely
+ * and wrap with a mask.
+ */
+ByteQueue::ByteQueue(int size) : head(0), tail(0)
+{
+    uint cap = 1;
+    while(cap < (uint)size)
+        cap <<= 1;
+    buffer = new char[cap];
+    mask = cap-1;
+}
+
+ByteQueue::~ByteQueue()
+{
+    delete [] buffer;
+}
+
+/*
+ * Producer side. Copies as much of data as fits and returns the count.
+ */
+int ByteQueue::put(const char *data, int length)
+{
+    uint h = (uint)head.fetchAndAddOrdered(0);
+    uint t = (uint)tail.fetchAndAddOrdered(0);
+    uint room = (mask+1) - (h-t);
+    uint len = (uint)length < room ? (uint)length : room;
+
+    for(uint n = 0; n < len; ) {
+        uint pos = (h+n) & mask;
+        uint run = (mask+1) - pos;
+        if(run > len-n)
+            run = len-n;
+        memcpy(buffer+pos, data+n, run);
+        n += run;
+    }
+    head.fetchAndStoreOrdered((int)(h+len));
+    return (int)len;
+}
+
+/*
+ * Consumer side. Returns everything queued so far.
+ */
+QByteArray ByteQueue::take()
+{
+    uint t = (uint)tail.fetchAndAddOrdered(0);
+    uint h = (uint)head.fetchAndAddOrdered(0);
+    uint len = h-t;
+
+    QByteArray ba;
+    if(len == 0)
+        return ba;
+    ba.resize((int)len);
+    for(uint n = 0; n < len; ) {
+        uint pos = (t+n) & mask;
+        uint run = (mask+1) - pos;
+        if(run > len-n)
+            run = len-n;
+        memcpy(ba.data()+n, buffer+pos, run);
+        n += run;
+    }
+    tail.fetchAndStoreOrdered((int)(t+len));
+    return ba;
+}
+
+int ByteQueue::count() const
+{
+    ByteQueue *q = const_cast<ByteQueue*>(this);
+    return (int)((uint)q->head.fetchAndAddOrdered(0) - (uint)q->tail.fetchAndAddOrdered(0));
+}
+
+int ByteQueue::space() const
+{
+    return (int)(mask+1) - count();
+}
+
+/*
+ * Only safe while the producer is stopped.
+ */
+void ByteQueue::clear()
+{
+    tail.fetchAndStoreOrdered(head.fetchAndAddOrdered(0));
+}
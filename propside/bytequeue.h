@@ -0,0 +1,55 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BYTEQUEUE_H
+#define BYTEQUEUE_H
+
+#include <QtCore>
+
+/*
+ * ByteQueue is a fixed size ring for passing received bytes from one
+ * reader thread to the GUI thread without a lock.
+ *
+ * Only one thread may put() and only one thread may take(). Each side
+ * owns one index and publishes it with an ordered atomic store, so the
+ * other side never sees an index before the bytes it covers.
+ */
+class ByteQueue
+{
+public:
+    explicit ByteQueue(int size = 0x40000);
+    ~ByteQueue();
+
+    int  put(const char *data, int length);
+    QByteArray take();
+
+    int  count() const;
+    int  space() const;
+    void clear();
+
+private:
+    Q_DISABLE_COPY(ByteQueue)
+
+    char       *buffer;
+    uint        mask;
+    QAtomicInt  head;   // next byte to write, owned by the producer
+    QAtomicInt  tail;   // next byte to read, owned by the consumer
+};
+
+#endif // BYTEQUEUE_H
@@ -0,0 +1,179 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "capturefile.h"
+
+CaptureFile::CaptureFile() : active(0)
+{
+    stamps = false;
+    mapped = false;
+    map = NULL;
+    mapStart = 0;
+    written = 0;
+}
+
+CaptureFile::~CaptureFile()
+{
+    close();
+}
+
+/*
+ * Start a new capture. Returns false and sets errorString() on failure.
+ */
+bool CaptureFile::open(const QString &fileName, bool timestamps, bool mapped)
+{
+    close();
+
+    QMutexLocker locker(&mutex);
+    error = "";
+    filePath = fileName;
+    stamps = timestamps;
+    this->mapped = mapped;
+    written = 0;
+    mapStart = 0;
+
+    file.setFileName(fileName);
+    if(!file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+        error = file.errorString();
+        return false;
+    }
+    if(mapped && !remap(0)) {
+        // some file systems can't map, fall back to plain writes
+        this->mapped = false;
+        file.resize(0);
+    }
+
+    if(stamps) {
+        index.setFileName(fileName+".idx");
+        if(!index.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            error = index.errorString();
+            unmap();
+            file.close();
+            return false;
+        }
+        index.write("# offset\tmsecs since epoch\tbytes\n");
+    }
+
+    active.fetchAndStoreOrdered(1);
+    return true;
+}
+
+/*
+ * Stop the capture. A mapped file is cut back to the bytes written.
+ */
+void CaptureFile::close()
+{
+    active.fetchAndStoreOrdered(0);
+
+    QMutexLocker locker(&mutex);
+    if(file.isOpen()) {
+        if(mapped) {
+            unmap();
+            file.resize(written);
+        }
+        file.close();
+    }
+    if(index.isOpen())
+        index.close();
+}
+
+bool CaptureFile::isOpen() const
+{
+    CaptureFile *cf = const_cast<CaptureFile*>(this);
+    return cf->active.fetchAndAddOrdered(0) != 0;
+}
+
+qint64 CaptureFile::bytesWritten()
+{
+    QMutexLocker locker(&mutex);
+    return written;
+}
+
+/*
+ * Append one chunk as read from the port. Called from the listener thread.
+ */
+bool CaptureFile::write(const char *data, int length)
+{
+    QMutexLocker locker(&mutex);
+    if(!file.isOpen())
+        return false;
+
+    if(stamps) {
+        QString line = QString("%1\t%2\t%3\n").arg(written)
+                .arg(QDateTime::currentMSecsSinceEpoch()).arg(length);
+        index.write(line.toLatin1());
+    }
+
+    bool ok;
+    if(mapped) {
+        ok = writeMapped(data, length);
+    }
+    else {
+        ok = file.write(data, length) == length;
+        if(ok)
+            written += length;
+    }
+    if(!ok) {
+        error = file.errorString();
+        active.fetchAndStoreOrdered(0);
+    }
+    return ok;
+}
+
+bool CaptureFile::writeMapped(const char *data, int length)
+{
+    int n = 0;
+    while(n < length) {
+        qint64 room = mapStart+MAP_BLOCK - written;
+        if(room <= 0) {
+            if(!remap(written))
+                return false;
+            continue;
+        }
+        int run = (length-n < room) ? length-n : (int)room;
+        memcpy(map + (written-mapStart), data+n, run);
+        written += run;
+        n += run;
+    }
+    return true;
+}
+
+/*
+ * Map the block starting at offset, growing the file to cover it.
+ */
+bool CaptureFile::remap(qint64 offset)
+{
+    unmap();
+    if(!file.resize(offset+MAP_BLOCK))
+        return false;
+    map = file.map(offset, MAP_BLOCK);
+    if(map == NULL)
+        return false;
+    mapStart = offset;
+    return true;
+}
+
+void CaptureFile::unmap()
+{
+    if(map != NULL) {
+        file.unmap(map);
+        map = NULL;
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAPTUREFILE_H
+#define CAPTUREFILE_H
+
+#include <QtCore>
+
+/*
+ * CaptureFile records raw serial data from the PortListener thread.
+ *
+ * Bytes are written unchanged so the file is an exact copy of the
+ * stream. With timestamps on, each chunk gets a line in a side file
+ * named <file>.idx giving its offset, arrival time and length. With
+ * mapping on, the file grows in MAP_BLOCK steps and is written through
+ * a memory map instead of write calls.
+ *
+ * open() and close() are called from the GUI, write() from the
+ * listener thread.
+ */
+class CaptureFile
+{
+public:
+    CaptureFile();
+    ~CaptureFile();
+
+    bool open(const QString &fileName, bool timestamps, bool mapped);
+    void close();
+    bool isOpen() const;
+    bool write(const char *data, int length);
+
+    qint64  bytesWritten();
+    QString fileName() const        { return filePath; }
+    QString errorString() const     { return error; }
+
+private:
+    Q_DISABLE_COPY(CaptureFile)
+
+    enum { MAP_BLOCK = 0x400000 };
+
+    bool writeMapped(const char *data, int length);
+    bool remap(qint64 offset);
+    void unmap();
+
+    QMutex      mutex;
+    QAtomicInt  active;
+    QFile       file;
+    QFile       index;
+    QString     filePath;
+    QString     error;
+    bool        stamps;
+    bool        mapped;
+    uchar      *map;
+    qint64      mapStart;
+    qint64      written;
+};
+
+#endif // CAPTUREFILE_H
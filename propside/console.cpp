@@ -45,6 +45,14 @@ Console::Console(QWidget *parent) : QPlainTextEdit(parent)
     for(int n = 0; n < maxhex; n++)
         hexbyte[n] = 0;
     sbuff = NULL;
+    crow = 0;
+    ccol = 0;
+    beepPending = false;
+    rendering = false;
+    connect(document(), SIGNAL(contentsChange(int,int,int)), this, SLOT(documentChanged(int,int,int)));
+    frameTimer.setSingleShot(true);
+    frameTimer.setInterval(FRAME_MSECS);
+    connect(&frameTimer, SIGNAL(timeout()), this, SLOT(render()));
     // experimenting with wraps ... just turn it off.
     this->setLineWrapMode(QPlainTextEdit::NoWrap);
 }
@@ -143,7 +151,10 @@ void Console::keyPressEvent(QKeyEvent *event)
         if(!s.length())
             return;
         if(this->enableEchoOn) {
-            this->insertPlainText(s);
+            QByteArray ba = s.toUtf8();
+            for(int n = 0; n < ba.length(); n++)
+                update(ba.at(n));
+            render();
         }
         parentMain->keyHandler(event);
     }
@@ -285,283 +296,293 @@ void Console::setHexDump(bool enable)
     hexdump = enable;
 }
 
-#ifdef EVENT_DRIVEN
-enum { BUFFERSIZE = 2048 };
-#else
-#ifdef Q_OS_WIN32
-enum { BUFFERSIZE = 16 };
-#else
-enum { BUFFERSIZE = 64 };
-#endif
-#endif
-
-void Console::updateReady(QextSerialPort* port)
+/*
+ * Bytes already read from the serial port by the PortListener thread.
+ */
+void Console::updateReady(const QByteArray &data)
 {
-    char buf[BUFFERSIZE];
     if(isEnabled == false)
         return;
 
-#if 1
-    qint64 length = port->bytesAvailable();
-    if(length < 1) return;
+    feed(data);
+}
 
-    QByteArray ba = port->readAll();
-    length = ba.length();
-#else
-    if(port->bytesAvailable() < 1)
+void Console::updateReady(XEsp8266port* port)
+{
+    if(isEnabled == false)
         return;
-    int length = port->readLine(buf,BUFFERSIZE);
-    //int length = ba.length();
 
-    if(length < 1)
+    if(port->bytesAvailable() < 1)
         return;
-#endif
 
+    feed(port->readAll());
+}
+
+/*
+ * Apply received bytes to the screen model and schedule a repaint.
+ * The widget is only touched by render() once per frame so a fast
+ * stream doesn't pay for a document edit on every character.
+ */
+void Console::feed(const QByteArray &ba)
+{
+    int length = ba.length();
     if(hexmode != false) {
         for(int n = 0; n < length; n++)
-            dumphex((int)buf[n]);
+            dumphex((int)ba.at(n));
     }
     else {
-#if 1
-        int jcount = 200;
-        // limit amount of time spent doing event updates
-        int evlimit= 100;
-        this->setSerialPollEnable(false);
-        while (length > 0) {
-            int jj = (length > jcount) ? jcount : length;
-            while(jj > 0) {
-                extern bool g_ApplicationClosing;
-                if (g_ApplicationClosing) return;
-                for(int n = 0; n < jj; n++) {
-                    update(ba.at(n));
-                }
-                QApplication::processEvents(QEventLoop::AllEvents, evlimit);
-
-                ba.remove(0,jj);
-                length = ba.length();
-                jj = (length > jcount) ? jcount : length;
+        for(int n = 0; n < length; n++)
+            update(ba.at(n));
+    }
+    if(!frameTimer.isActive())
+        frameTimer.start();
+}
 
-                //QApplication::processEvents(QEventLoop::AllEvents, evlimit);
-            }
-            if (port->isOpen()) {
-                ba = port->readAll();
-                length = ba.length();
+/*
+ * Copy the changed part of the screen model to the document in one edit.
+ */
+void Console::render()
+{
+    frameTimer.stop();
+
+    if(screen.isDirty()) {
+        QTextDocument *doc = document();
+        QTextCursor cur(doc);
+        rendering = true;
+        cur.beginEditBlock();
+        int evicted = screen.evicted();
+        if(screen.isReset() || evicted >= doc->blockCount()) {
+            cur.select(QTextCursor::Document);
+            cur.insertText(screen.text());
+        }
+        else {
+            if(evicted > 0) {
+                cur.movePosition(QTextCursor::Start, QTextCursor::MoveAnchor);
+                cur.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor, evicted);
+                cur.removeSelectedText();
             }
+            int from = screen.dirtyFrom();
+            if(from > doc->blockCount()-1)
+                from = doc->blockCount()-1;
+            if(from > screen.count()-1)
+                from = screen.count()-1;
+            cur.setPosition(doc->findBlockByNumber(from).position());
+            cur.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
+            cur.insertText(screen.text(from));
         }
-        this->setSerialPollEnable(true);
-#else
-        for(int n = 0; n < length; n++)
-            update(buf[n]);
-#endif
+        cur.endEditBlock();
+        rendering = false;
+        screen.clean();
+
+        QTextBlock block = doc->findBlockByNumber(crow);
+        if(block.isValid()) {
+            int col = ccol < block.length()-1 ? ccol : block.length()-1;
+            cur.setPosition(block.position()+col);
+        }
+        else {
+            cur.movePosition(QTextCursor::End);
+        }
+        setTextCursor(cur);
+    }
+
+    if(beepPending) {
+        beepPending = false;
+        QApplication::beep();
     }
-    QApplication::processEvents();
 }
 
-void Console::updateReady(XEsp8266port* port)
+/*
+ * Keep the screen model in step with text set directly on the widget.
+ */
+void Console::setPlainText(const QString &text)
 {
-    if(isEnabled == false)
-        return;
+    frameTimer.stop();
+    QPlainTextEdit::setPlainText(text);
+    syncScreen();
+}
+
+/*
+ * The scrollback limit is kept by the screen ring rather than the
+ * document so lines are dropped as they arrive instead of per block.
+ */
+void Console::setMaximumBlockCount(int count)
+{
+    int drop = screen.setMaxLines(count);
+    crow -= drop;
+    if(crow < 0) {
+        crow = 0;
+        ccol = 0;
+    }
+    render();
+}
+
+int Console::maximumBlockCount() const
+{
+    return screen.maxLines();
+}
 
-    qint64 length = port->bytesAvailable();
-    if(length < 1) return;
+/*
+ * Edits that don't come from render, like the context menu, drag and
+ * drop, or calls through a QPlainTextEdit pointer, change the document
+ * behind the screen model. Read the model back from the document.
+ */
+void Console::documentChanged(int position, int removed, int added)
+{
+    Q_UNUSED(position);
+    Q_UNUSED(removed);
+    Q_UNUSED(added);
+    if(!rendering)
+        syncScreen();
+}
 
-    QByteArray ba = port->readAll();
-    length = ba.length();
+void Console::syncScreen()
+{
+    screen.setText(toPlainText());
+    screen.clean();
+    QTextCursor cur = textCursor();
+    crow = cur.blockNumber();
+    ccol = cur.columnNumber();
+}
 
-    if(hexmode != false) {
-        for(int n = 0; n < length; n++)
-            dumphex((int)ba[n]);
-    }
-    else {
-        int jcount = 200;
-        // limit amount of time spent doing event updates
-        int evlimit= 100;
-        while (length > 0) {
-            int jj = (length > jcount) ? jcount : length;
-            while(jj > 0) {
-                extern bool g_ApplicationClosing;
-                if (g_ApplicationClosing) return;
-                for(int n = 0; n < jj; n++) {
-                    update(ba.at(n));
-                }
-                QApplication::processEvents(QEventLoop::AllEvents, evlimit);
+/*
+ * Pad the cursor line with spaces so column col exists.
+ */
+void Console::padLine(int col)
+{
+    QString &line = screen.line(crow);
+    while(line.length() < col)
+        line += ' ';
+}
 
-                ba.remove(0,jj);
-                length = ba.length();
-                jj = (length > jcount) ? jcount : length;
+/*
+ * Move the cursor to row, adding lines as needed. A full screen doesn't
+ * grow so the cursor stops on its last line.
+ */
+void Console::moveToRow(int row)
+{
+    while(screen.count() <= row && !screen.isFull())
+        screen.insertLine(screen.count());
+    if(row > screen.count()-1)
+        row = screen.count()-1;
+    crow = row > 0 ? row : 0;
+}
 
-                //QApplication::processEvents(QEventLoop::AllEvents, evlimit);
-            }
-            if (port->isOpen()) {
-                ba = port->readAll();
-                length = ba.length();
-            }
-        }
-        // simple but very slow way
-        // for(int n = 0; n < length; n++) update(ba[n]);
-    }
-    QApplication::processEvents();
+/*
+ * Split the cursor line at the cursor like QTextCursor::insertBlock.
+ */
+void Console::splitLine()
+{
+    QString &line = screen.line(crow);
+    QString rest = line.mid(ccol);
+    line.truncate(ccol);
+    crow -= screen.insertLine(crow+1, rest);
+    crow++;
+    ccol = 0;
 }
 
 void Console::dumphex(int ch)
 {
     unsigned char c = ch;
-    QTextCursor cur = this->textCursor();
     // always start at the end just in case someone clicked the window
-    moveCursor(QTextCursor::End);
+    crow = screen.count()-1;
+    ccol = screen.at(crow).length();
 
     if(hexdump != true) {
         if(wrapMode > 0) {
-            if(cur.block().length() > wrapMode)
-                cur.insertBlock();
+            if(screen.at(crow).length()+1 > wrapMode)
+                splitLine();
         }
-        else if(cur.block().length() > maxcol-2) {
-            cur.insertBlock();
+        else if(screen.at(crow).length()+1 > maxcol-2) {
+            splitLine();
         }
 
-        cur.insertText(QString(" %1").arg(c,2,16,QChar('0')));
+        screen.line(crow) += QString(" %1").arg(c,2,16,QChar('0'));
     }
     else {
         int byte = hexbytes % maxhex;
         if(byte == 0) {
-            cur.insertText(QString("  "));
+            QString &line = screen.line(crow);
+            line += QString("  ");
             for(int n = 0; n < maxhex; n++) {
                 if(isprint(hexbyte[n]))
-                    cur.insertText(QString(hexbyte[n]));
+                    line += QChar(hexbyte[n]);
                 else
-                    cur.insertText(QString("."));
+                    line += QChar('.');
             }
-            cur.insertBlock();
+            ccol = line.length();
+            splitLine();
         }
         hexbyte[byte] = ch;
         hexbytes++;
 
-        cur.insertText(QString(" %1").arg(c,2,16,QChar('0')));
+        screen.line(crow) += QString(" %1").arg(c,2,16,QChar('0'));
     }
+    ccol = screen.at(crow).length();
 }
 
 void Console::setCursorMode()
 {
-    QTextCursor cur = this->textCursor();
     this->setWordWrapMode(QTextOption::WrapAnywhere);
 
     if(wrapMode > 0) {
-        if(cur.block().length() > wrapMode)
-            cur.insertBlock();
+        if(screen.at(crow).length()+1 > wrapMode)
+            splitLine();
     }
-    else if(cur.block().length() > maxcol) {
-        cur.insertBlock();
+    else if(screen.at(crow).length()+1 > maxcol) {
+        splitLine();
     }
 }
 
 void Console::update(char ch)
 {
-    int _x, _y;
-
-    QString text = "";
-    QTextCursor cur = this->textCursor();
-
-    this->setWordWrapMode(QTextOption::WrapAnywhere);
+    if(crow > screen.count()-1)
+        crow = screen.count()-1;
+    if(ccol > screen.at(crow).length())
+        ccol = screen.at(crow).length();
 
     if(wrapMode > 0) {
-        if(cur.block().length() > wrapMode)
-            cur.insertBlock();
+        if(screen.at(crow).length()+1 > wrapMode)
+            splitLine();
     }
-    else if(cur.block().length() > maxcol) {
-        cur.insertBlock();
+    else if(screen.at(crow).length()+1 > maxcol) {
+        splitLine();
     }
 
-    // always start at the end just in case someone clicked the window
-    //moveCursor(QTextCursor::End);
     // now that we have cursor positioning we can't always start at the end.
 
-    //qDebug(QString(" %1 %2").arg(ch, 2, 16, QChar('0')).arg(QChar(ch)).toLatin1());
-    //insertPlainText(QString(" %1 ").arg(ch, 2, 16, QChar('0')));
-    //insertPlainText(QChar(ch));
-
-    _x = cur.columnNumber();
-    _y = cur.blockNumber();
-
-
-    //qDebug() << QString("%1 %2 %3 %4 %5").arg(pcmd,2,10,QChar('0')).arg(pcmdx,2,10,QChar('0')).arg(pcmdy,2,10,QChar('0')).arg(ch,2,10,QChar('0')).arg(ch,1,QChar('0'));
-    //qDebug() << QString("P %1,%2 X,Y %3,%4 %5").arg(pcmdx,2,10,QChar('0')).arg(pcmdy,2,10,QChar('0')).arg(cur.columnNumber(),2,10,QChar('0')).arg(cur.blockNumber(),2,10,QChar('0')).arg(ch,2,10,QChar('0'));
     switch(pcmd)
     {
         case PCMD_CURPOS_X: {
                 pcmdx = ch;
-                qDebug() << "CURPOS_X " << pcmdx;
-#if 0
-                cur.movePosition(QTextCursor::Start,QTextCursor::MoveAnchor);
-                cur.movePosition(QTextCursor::Down,QTextCursor::MoveAnchor,pcmdy);
-                setTextCursor(cur);
-#endif
-#if 1
-                int j = cur.block().length();
-                for(; j <= pcmdx; j++) {
-                    cur.movePosition(QTextCursor::EndOfLine,QTextCursor::MoveAnchor);
-                    cur.insertText(" ");
-                }
-#endif
-                cur.movePosition(QTextCursor::StartOfLine,QTextCursor::MoveAnchor);
-                if(pcmdx > 0) cur.movePosition(QTextCursor::Right,QTextCursor::MoveAnchor,pcmdx);
-                setTextCursor(cur);
+                padLine(pcmdx);
+                ccol = pcmdx > 0 ? pcmdx : 0;
                 pcmd = PCMD_NONE;
-                qDebug() << "CURPOS_X Column" << cur.columnNumber();
             }
             break;
 
         case PCMD_CURPOS_Y: {
                 pcmdy = ch;
-                qDebug() << "CURPOS_Y " << pcmdy;
-                int j = this->blockCount();
-                for(; j <= pcmdy; j++) {
-                    cur.movePosition(QTextCursor::End);
-                    cur.insertBlock(cur.blockFormat(),cur.charFormat());
-                }
-                cur.movePosition(QTextCursor::Start,QTextCursor::MoveAnchor);
-                if(pcmdy > 0) cur.movePosition(QTextCursor::Down,QTextCursor::MoveAnchor,pcmdy);
-                setTextCursor(cur);
-#if 0
-                cur.movePosition(QTextCursor::StartOfLine,QTextCursor::MoveAnchor);
-                cur.movePosition(QTextCursor::Right,QTextCursor::MoveAnchor,pcmdx);
-                setTextCursor(cur);
-#endif
+                moveToRow(pcmdy);
+                if(ccol > screen.at(crow).length())
+                    ccol = screen.at(crow).length();
                 pcmd = PCMD_NONE;
-                qDebug() << "CURPOS_Y Column" << cur.columnNumber();
             }
             break;
 
         case PCMD_CURPOS_XY: {
-#if 1
             if(pcmdlen == 2) {
                 pcmdx = ch;
             }
             else if(pcmdlen == 1) {
                 pcmdy = ch;
-                int j = this->blockCount();
-                for(; j <= pcmdy; j++) {
-                    cur.movePosition(QTextCursor::End);
-                    cur.insertBlock();
-                }
-                cur.movePosition(QTextCursor::Start,QTextCursor::MoveAnchor);
-                if(pcmdy > 0)
-                    cur.movePosition(QTextCursor::Down, QTextCursor::MoveAnchor, pcmdy);
-
-                j = cur.block().length();
-                for(; j <= pcmdx; j++) {
-                    cur.movePosition(QTextCursor::EndOfLine,QTextCursor::MoveAnchor);
-                    cur.insertText(" ");
-                }
-                cur.movePosition(QTextCursor::StartOfLine,QTextCursor::MoveAnchor);
-                if(pcmdx > 0)
-                    cur.movePosition(QTextCursor::Right,QTextCursor::MoveAnchor,pcmdx);
-                setTextCursor(cur);
+                moveToRow(pcmdy);
+                padLine(pcmdx);
+                ccol = pcmdx > 0 ? pcmdx : 0;
             }
             pcmdlen--;
             if(pcmdlen < 1) {
                 pcmd = PCMD_NONE;
             }
-#endif
         }
         break;
 
@@ -578,7 +599,8 @@ void Console::update(char ch)
 
                     if (utfbytes == 0) {
                         utfparse = false;
-                        cur.insertText(QChar(utf8));
+                        screen.line(crow).insert(ccol, QChar(utf8));
+                        ccol++;
                     }
                 } else {
                     utfparse = true;
@@ -602,21 +624,25 @@ void Console::update(char ch)
             {
             case EN_ClearScreen: {
                     if(this->enableClearScreen) {
-                        setPlainText("");
+                        screen.clear();
+                        crow = 0;
+                        ccol = 0;
                     }
                 }
                 break;
             case EN_ClearScreen2: {
                     if(this->enableClearScreen16) {
-                        setPlainText("");
+                        screen.clear();
+                        crow = 0;
+                        ccol = 0;
                     }
                 }
                 break;
 
             case EN_HomeCursor: {
                     if(this->enableHomeCursor) {
-                        cur.movePosition(QTextCursor::Start,QTextCursor::MoveAnchor);
-                        setTextCursor(cur);
+                        crow = 0;
+                        ccol = 0;
                     }
                 }
                 break;
@@ -647,37 +673,26 @@ void Console::update(char ch)
 
                 case EN_MoveCursorLeft: {
                         if(this->enableMoveCursorLeft) {
-                            if(cur.columnNumber() > 0) {
-                                cur.movePosition(QTextCursor::Left,QTextCursor::MoveAnchor);
-                                setTextCursor(cur);
-                            }
+                            if(ccol > 0)
+                                ccol--;
                         }
                     }
                     break;
 
                 case EN_MoveCursorRight: {
                         if(this->enableMoveCursorRight) {
-                            if(cur.columnNumber() >= cur.block().length()-1)
-                                cur.insertText(" ");
-                            cur.movePosition(QTextCursor::Right,QTextCursor::MoveAnchor);
-                            setTextCursor(cur);
+                            if(ccol >= screen.at(crow).length())
+                                screen.line(crow) += ' ';
+                            ccol++;
                         }
                     }
                     break;
 
                 case EN_MoveCursorUp: {
                         if(this->enableMoveCursorUp) {
-                            if(cur.blockNumber() > 0) {
-                                int col = cur.columnNumber();
-                                qDebug() << "MU Column" << col;
-                                cur.movePosition(QTextCursor::Up,QTextCursor::MoveAnchor);
-                                int end = cur.block().length();
-                                for(int n = end; n <= col; n++) {
-                                    cur.insertText(" ");
-                                }
-                                cur.movePosition(QTextCursor::StartOfLine,QTextCursor::MoveAnchor);
-                                cur.movePosition(QTextCursor::Right,QTextCursor::MoveAnchor,col);
-                                setTextCursor(cur);
+                            if(crow > 0) {
+                                crow--;
+                                padLine(ccol);
                             }
                         }
                     }
@@ -685,56 +700,49 @@ void Console::update(char ch)
 
                 case EN_MoveCursorDown: {
                         if(this->enableMoveCursorDown) {
-                            int col = cur.columnNumber();
-                            int row = cur.blockNumber();
-                            int cnt = this->blockCount();
-                            int end = cur.block().length();
-                            qDebug() << "MD Column" << col;
-                            if(row+1 < cnt) {
-                                cur.movePosition(QTextCursor::Down,QTextCursor::MoveAnchor);
-                                end = cur.block().length();
-                                for(int n = end; n <= col; n++) {
-                                    cur.insertText(" ");
-                                    cur.movePosition(QTextCursor::EndOfLine,QTextCursor::MoveAnchor);
-                                }
-                                end = cur.block().length();
-                                cur.movePosition(QTextCursor::StartOfLine,QTextCursor::MoveAnchor);
-                                cur.movePosition(QTextCursor::Right,QTextCursor::MoveAnchor, col);
+                            int col = ccol;
+                            if(crow+1 < screen.count()) {
+                                crow++;
+                                padLine(col);
+                                ccol = col;
                             } else {
-                                cur.insertBlock();
+                                splitLine();
                                 for(int n = 1; n < col; n++) {
-                                    cur.insertText(" ");
+                                    screen.line(crow).insert(ccol, ' ');
+                                    ccol++;
                                 }
                             }
-                            setTextCursor(cur);
                         }
                     }
                     break;
 
             case EN_BeepSpeaker: {
                     if(this->enableBeepSpeaker) {
-                        QApplication::beep();
+                        beepPending = true;
                     }
                 }
                 break;
 
             case EN_Backspace: {
                     if(this->enableBackspace) {
-                        text = toPlainText();
-                        setPlainText(text.mid(0,text.length()-1));
-                        moveCursor(QTextCursor::End);
+                        int last = screen.count()-1;
+                        if(screen.at(last).length() > 0)
+                            screen.line(last).chop(1);
+                        else if(last > 0)
+                            screen.removeLine(last);
+                        crow = screen.count()-1;
+                        ccol = screen.at(crow).length();
                     }
                 }
                 break;
 
             case EN_Tab: {
                     if(this->enableTab) {
-                        int column = cur.columnNumber() % tabsize;
+                        int column = ccol % tabsize;
                         while(column++ < tabsize) {
-                            moveCursor(QTextCursor::Right,QTextCursor::MoveAnchor);
-                            cur.insertText(" ");
+                            screen.line(crow).insert(ccol, ' ');
+                            ccol++;
                         }
-                        setTextCursor(cur);
                     }
                 }
                 break;
@@ -746,36 +754,23 @@ void Console::update(char ch)
             case EN_CReturn: {
                     if(ch == newline) {
                         if(enableNewLine) {
-                            int row = cur.blockNumber();
-                            int max = this->blockCount()-1;
-                            if(row < max) {
-                                // insert a newline
-                                cur.movePosition(QTextCursor::EndOfLine,QTextCursor::KeepAnchor);
-                                text = cur.selectedText();
-                                cur.removeSelectedText();
-                                cur.movePosition(QTextCursor::Down,QTextCursor::MoveAnchor);
-                                cur.movePosition(QTextCursor::StartOfLine,QTextCursor::MoveAnchor);
-                                cur.insertText(text);
+                            if(crow < screen.count()-1) {
+                                // move the rest of the line down
+                                QString &line = screen.line(crow);
+                                QString text = line.mid(ccol);
+                                line.truncate(ccol);
+                                crow++;
+                                screen.line(crow).insert(0, text);
+                                ccol = text.length();
                             }
                             else {
-                                cur.insertBlock();
-                            }
-#if 0
-                            if(this->enableAddCRtoNL == false) {
-                                while(col-- > -1) {
-                                    cur.insertText(" ");
-                                    cur.movePosition(QTextCursor::Right,QTextCursor::MoveAnchor, 1);
-                                }
+                                splitLine();
                             }
-#endif
-                            setTextCursor(cur);
                         }
                     }
                     else if(ch == creturn) {
                         if(enableCReturn) {
-                            text = toPlainText();
-                            cur.movePosition(QTextCursor::StartOfLine,QTextCursor::MoveAnchor);
-                            setTextCursor(cur);
+                            ccol = 0;
                         }
                     }
                 }
@@ -783,44 +778,28 @@ void Console::update(char ch)
 
             case EN_ClearToEOL: {
                     if(this->enableClearToEOL) {
-                        int end = cur.block().length();
-                        int col = cur.columnNumber();
-                        if(end > col) {
-                            cur.clearSelection();
-                            cur.movePosition(QTextCursor::Right,QTextCursor::KeepAnchor,end-col-1);
-                            text = cur.selectedText();
-                            col = cur.columnNumber();
-                            if(text.length()) {
-                                cur.removeSelectedText();
-                                col = cur.columnNumber();
-                                text = cur.selectedText();
-                                col = cur.columnNumber();
-                                setTextCursor(cur);
-                                col = cur.columnNumber();
-                            }
-                        }
+                        if(screen.at(crow).length() > ccol)
+                            screen.line(crow).truncate(ccol);
                     }
                 }
                 break;
 
             case EN_ClearLinesBelow: {
                     if(this->enableClearLinesBelow) {
-                        int row = cur.blockNumber();
-                        int col = cur.columnNumber();
-                        cur.movePosition(QTextCursor::Start,QTextCursor::MoveAnchor);
-                        cur.movePosition(QTextCursor::Down,QTextCursor::KeepAnchor,row);
-                        cur.movePosition(QTextCursor::Right,QTextCursor::KeepAnchor,col);
-                        QString s = cur.selectedText();
-                        this->setPlainText(s);
+                        screen.truncate(crow+1);
+                        if(screen.at(crow).length() > ccol)
+                            screen.line(crow).truncate(ccol);
                     }
                 }
                 break;
 
             default: {
-                    if(cur.block().length()-1 > cur.columnNumber())
-                        cur.movePosition(QTextCursor::Right,QTextCursor::KeepAnchor);
-                    cur.insertText(QString(ch));
-                    setTextCursor(cur);
+                    QString &line = screen.line(crow);
+                    if(line.length() > ccol)
+                        line[ccol] = QChar(ch);
+                    else
+                        line += QChar(ch);
+                    ccol++;
                 }
                 break;
             }
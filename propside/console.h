@@ -23,6 +23,10 @@
 #include "qtversion.h"
 #include "qextserialport.h"
 #include "xesp8266port.h"
+#include "termscreen.h"
+
+/* repaint at most this often while data is streaming */
+#define FRAME_MSECS 20
 
 class Console : public QPlainTextEdit
 {
@@ -34,6 +38,9 @@ public:
     void setSerialPollEnable(bool value);
     bool serialPollEnabled();
     void clear();
+    void setPlainText(const QString &text);
+    void setMaximumBlockCount(int count);
+    int  maximumBlockCount() const;
     QString eventKey(QKeyEvent* event);
 
     void setCursorMode();
@@ -154,15 +161,32 @@ private:
     // screen buffer
     char *sbuff;
 
+    TermScreen screen;
+    int     crow;
+    int     ccol;
+    bool    beepPending;
+    bool    rendering;
+    QTimer  frameTimer;
+
+    void feed(const QByteArray &ba);
+    void syncScreen();
+    void padLine(int col);
+    void moveToRow(int row);
+    void splitLine();
+
 protected:
     void keyPressEvent(QKeyEvent* event);
     void resizeEvent(QResizeEvent *e);
 
 public slots:
-    void updateReady(QextSerialPort*);
+    void updateReady(const QByteArray &data);
     void updateReady(XEsp8266port *);
     void dumphex(int ch);
     void update(char ch);
+    void render();
+
+private slots:
+    void documentChanged(int position, int removed, int added);
 
 };
 
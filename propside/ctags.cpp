@@ -19,6 +19,7 @@
 
 #include "ctags.h"
 #include "mainwindow.h"
+#include "buildjobs.h"
 
 CTags::CTags(QString path, QObject *parent) : QObject(parent)
 {
@@ -36,7 +37,7 @@ CTags::CTags(QString path, QObject *parent) : QObject(parent)
     else
         ctagsFound = false;
 
-    process = new QProcess();
+    tagSize = -1;
 }
 
 int CTags::runCtags(QString path)
@@ -85,16 +86,6 @@ int CTags::runCtags(QString path)
     projectPath = projectPath.mid(0,projectPath.lastIndexOf("/")+1);
     QDir projdir(projectPath);
 
-    connect(process, SIGNAL(readyReadStandardOutput()),this,SLOT(procReadyRead()));
-    connect(process, SIGNAL(finished(int,QProcess::ExitStatus)),this,SLOT(procFinished(int,QProcess::ExitStatus)));
-    connect(process, SIGNAL(error(QProcess::ProcessError)), this, SLOT(procError(QProcess::ProcessError)));
-
-    process->setProcessChannelMode(QProcess::MergedChannels);
-    process->setWorkingDirectory(projectPath);
-
-    args.append("--format=1");
-    args.append("--recurse=yes");
-
     /* append project files */
     foreach(QString argstr, plist) {
         if(argstr.length() > 0) {
@@ -127,61 +118,214 @@ int CTags::runCtags(QString path)
     }
     args.removeDuplicates();
 
-    procDone = false;
-    /*
-    qDebug() << ctagsProgram.toLatin1();
-    for(int n = 0; n < args.count(); n++)
-        qDebug() << args.at(n);
-    */
-    process->start(ctagsProgram,args);
-
-    /* process Qt application events until procDone
+    /* nothing changed since the last run, the tags file is still good
      */
-    while(procDone == false)
-        QApplication::processEvents();
-
-    rc = process->exitCode();
+    if(args == lastArgs && tagsCurrent(args))
+        return 0;
+
+    /* only files changed since they were last tagged are read again */
+    rc = tagFiles(args);
+    if(!writeTags(args))
+        rc = -1;
+    if(rc == 0)
+        lastArgs = args;
+    loadTags();
     return rc;
 }
 
 /*
- * Spin ctags are collected when necessary by propside.
- * We only set the project path here.
+ * Run ctags over files that are new or changed since they were tagged.
+ * The files are split among parallel ctags processes writing to stdout.
  */
-int CTags::runSpinCtags(QString path, QString libpath)
+int CTags::tagFiles(QStringList files)
 {
-    projectPath = QDir::fromNativeSeparators(path);
-    projectPath = projectPath.mid(0,projectPath.lastIndexOf("/")+1);
-    return 0;
+    QDir projdir(projectPath);
+    QStringList changed;
+    foreach(QString file, files) {
+        QFileInfo info(projdir, file);
+        if(fileTags.contains(file)) {
+            const FileTags &tags = fileTags[file];
+            if(info.lastModified() == tags.modified && info.size() == tags.size)
+                continue;
+        }
+        changed.append(file);
+    }
+    if(changed.isEmpty())
+        return 0;
+
+    int jobCount = qMin(BuildJobs::defaultJobs(), changed.count());
+    QList<QStringList> batches;
+    for(int n = 0; n < jobCount; n++)
+        batches.append(QStringList());
+    for(int n = 0; n < changed.count(); n++)
+        batches[n % jobCount].append(changed[n]);
+
+    /* times are taken before ctags reads the files so edits made
+     * while it runs are picked up next time
+     */
+    QHash<QString,FileTags> found;
+    foreach(QString file, changed) {
+        QFileInfo info(projdir, file);
+        FileTags tags;
+        tags.modified = info.lastModified();
+        tags.size = info.size();
+        found.insert(file, tags);
+    }
+
+    BuildJobs jobs(jobCount);
+    foreach(QStringList batch, batches) {
+        QStringList args;
+        args.append("--format=1");
+        args.append("--recurse=yes");
+        args.append("-f");
+        args.append("-");
+        args.append(batch);
+        jobs.addJob(ctagsProgram, projectPath, args);
+    }
+    jobs.run();
+
+    int rc = 0;
+    for(int n = 0; n < jobs.count(); n++) {
+        if(jobs.jobFailed(n)) {
+            qDebug() << "runCtags failed" << jobs.jobExitCode(n) << jobs.jobOutput(n);
+            rc = jobs.jobExitCode(n) ? jobs.jobExitCode(n) : -1;
+            continue;
+        }
+        QStringList lines = QString(jobs.jobOutput(n)).split("\n", QString::SkipEmptyParts);
+        foreach(QString line, lines) {
+            if(line.endsWith('\r'))
+                line.chop(1);
+            if(line.startsWith('!'))
+                continue;
+            QStringList item = line.split("\t");
+            if(item.count() < 3)
+                continue;
+            /* a folder argument owns the files ctags found under it */
+            QString file = item.at(1);
+            if(!found.contains(file)) {
+                foreach(QString key, batches[n]) {
+                    if(file.startsWith(key+"/")) {
+                        file = key;
+                        break;
+                    }
+                }
+            }
+            if(found.contains(file))
+                found[file].lines.append(line);
+        }
+        foreach(QString file, batches[n]) {
+            fileTags.insert(file, found.value(file));
+        }
+    }
+    return rc;
 }
 
-void CTags::procError(QProcess::ProcessError code)
+/*
+ * Write the sorted tags of files to the project tags file.
+ */
+bool CTags::writeTags(QStringList files)
 {
-    mutex.lock();
-    procDone = true;
-    mutex.unlock();
-    if(code != 0)
-        qDebug() << "ctags procError " << code;
+    QStringList lines;
+    foreach(QString file, files) {
+        if(fileTags.contains(file))
+            lines.append(fileTags[file].lines);
+    }
+    lines.sort();
+
+    QFile tags(projectPath+"tags");
+    if(tags.open(QFile::WriteOnly | QFile::Truncate) == false)
+        return false;
+    QTextStream out(&tags);
+    out << "!_TAG_FILE_FORMAT\t1\t/original ctags format/\n";
+    out << "!_TAG_FILE_SORTED\t1\t/0=unsorted, 1=sorted, 2=foldcase/\n";
+    foreach(QString line, lines)
+        out << line << "\n";
+    out.flush();
+    tags.close();
+    return true;
 }
 
-void CTags::procReadyRead()
+/*
+ * True if the tags file is newer than every file ctags would read.
+ */
+bool CTags::tagsCurrent(QStringList args)
 {
-    QString output = process->readAllStandardOutput();
-    if(output.length() > 0)
-        qDebug() << "procReadyRead :" << output;
+    QFileInfo tags(projectPath+"tags");
+    if(!tags.exists())
+        return false;
+    QDateTime time = tags.lastModified();
+    QDir projdir(projectPath);
+    foreach(QString arg, args) {
+        QFileInfo info(projdir, arg);
+        if(!info.exists() || info.lastModified() > time)
+            return false;
+    }
+    return true;
 }
 
-void CTags::procFinished(int code, QProcess::ExitStatus status)
+/*
+ * Build the symbol index from the project tags file if it has changed
+ * since the last load. The tags file can also be written by SpinParser,
+ * so lookups check the file time and size before using the index.
+ * Returns true if the index has tags.
+ */
+bool CTags::loadTags()
 {
-    if(procDone)
-        return;
+    QString path = projectPath+"tags";
+    QFileInfo info(path);
+    if(!info.exists()) {
+        tagMap.clear();
+        tagNames.clear();
+        tagPath = "";
+        return false;
+    }
+    if(path == tagPath && info.lastModified() == tagTime && info.size() == tagSize)
+        return tagMap.count() > 0;
+
+    tagMap.clear();
+    tagNames.clear();
+    tagPath = path;
+    tagTime = info.lastModified();
+    tagSize = info.size();
 
-    mutex.lock();
-    procDone = true;
-    mutex.unlock();
+    QFile file(path);
+    if(file.open(QFile::ReadOnly) == false)
+        return false;
+
+    QString fileString = file.readAll();
+    file.close();
+
+    /* keep the first line for each symbol as the old search did */
+    QStringList list = fileString.split("\n");
+    foreach(QString line, list) {
+        if(line.length() == 0)
+            continue;
+        if(line.at(0) == '!')
+            continue;
+        int tab = line.indexOf('\t');
+        if(tab < 1)
+            continue;
+        if(line.endsWith('\r'))
+            line.chop(1);
+        QString key = line.left(tab).toLower();
+        if(!tagMap.contains(key)) {
+            tagMap.insert(key, line);
+            tagNames.append(key);
+        }
+    }
+    tagNames.sort();
+    return tagMap.count() > 0;
+}
 
-    if((code != 0) | (status != 0))
-        qDebug() << "runCtags procFinished " << code << " " << status << ":" << process->readAllStandardOutput();
+/*
+ * Spin ctags are collected when necessary by propside.
+ * We only set the project path here.
+ */
+int CTags::runSpinCtags(QString path, QString libpath)
+{
+    projectPath = QDir::fromNativeSeparators(path);
+    projectPath = projectPath.mid(0,projectPath.lastIndexOf("/")+1);
+    return 0;
 }
 
 bool CTags::enabled()
@@ -195,34 +339,26 @@ QString CTags::findTag(QString symbol)
     if(ctagsFound == false)
         return rets;
 
-    QFile file(projectPath+"tags");
-
-    if(file.exists() == false)
-        return rets;
-
-    if(file.open(QFile::ReadOnly) == false)
+    if(loadTags() == false)
         return rets;
 
-    QString fileString = file.readAll();
-    file.close();
+    return tagMap.value(symbol.toLower(), rets);
+}
 
-    if(fileString.contains(symbol,Qt::CaseInsensitive)) {
-        QStringList list = fileString.split("\n");
-        QRegExp rx("^"+symbol+"[ \t].*",Qt::CaseInsensitive);
-        for(int n = 0; n < list.length(); n++) {
-            QString line = list.at(n);
-            if(line.length() == 0)
-                continue;
-            if(line.at(0) == '!')
-                continue;
-            int pos = rx.indexIn(line);
-            if(pos > -1) {
-                rets = line;
-                break;
-            }
-        }
-    }
-    return rets;
+/*
+ * All tagged symbols starting with prefix, ignoring case.
+ */
+QStringList CTags::findTags(QString prefix)
+{
+    QStringList list;
+    if(ctagsFound == false || loadTags() == false)
+        return list;
+
+    prefix = prefix.toLower();
+    QStringList::const_iterator it = qLowerBound(tagNames.constBegin(), tagNames.constEnd(), prefix);
+    for(; it != tagNames.constEnd() && (*it).startsWith(prefix); ++it)
+        list.append(tagMap.value(*it));
+    return list;
 }
 
 QString CTags::getFile(QString line)
@@ -235,10 +371,25 @@ int CTags::getLine(QString line)
 {
     int rc = -1;
     QStringList item = line.split("\t");
-    QFile file(item.at(1));
-    if(file.exists() == false)
+    QFileInfo info(item.at(1));
+    if(info.exists() == false)
         return rc;
 
+    /* the file has to be read only when it changed since the last lookup
+     */
+    if(lineCache.contains(line)) {
+        TagLine tl = lineCache.value(line);
+        if(tl.modified == info.lastModified())
+            return tl.line;
+    }
+
+    QString rspec = item.at(2);
+    bool isnumber;
+    int num = rspec.toInt(&isnumber);
+    if(isnumber)
+        return num;
+
+    QFile file(item.at(1));
     QString filestr;
     QTextStream in(&file);
     in.setAutoDetectUnicode(true);
@@ -246,50 +397,30 @@ int CTags::getLine(QString line)
         filestr = in.readAll();
         file.close();
     }
-    QString rspec = item.at(2);
-    bool isnumber;
-    int num = rspec.toInt(&isnumber);
-    if(isnumber) {
-        return num;
-    }
-    else {
-        if(rspec.indexOf('^') > -1)
-            rspec = rspec.mid(rspec.indexOf('^')+1);
-        if(rspec.lastIndexOf('$') > 0)
-            rspec = rspec.mid(0,rspec.lastIndexOf('$'));
-        rspec = rspec.replace("\\","");
-        QRegExp rx(rspec,Qt::CaseSensitive, QRegExp::RegExp);
-        QRegExp rx2(rspec,Qt::CaseSensitive, QRegExp::RegExp2);
-        QRegExp rxwc(rspec,Qt::CaseSensitive, QRegExp::Wildcard);
-        QRegExp rxwcu(rspec,Qt::CaseSensitive, QRegExp::WildcardUnix);
-        QRegExp rxfs(rspec,Qt::CaseSensitive, QRegExp::FixedString);
-        QRegExp rxw3(rspec,Qt::CaseSensitive, QRegExp::W3CXmlSchema11);
-#if 0
-        /* could return the file position of the search string */
-        int pos = rxwc.indexIn(filestr);
-        if(pos > -1)
-            return pos;
-#else
-        QStringList list = filestr.split("\n");
-        /* searching backwards increases chance of finding
-         * the function definition instead of a declaration.
-         */
-        for(int n = list.length()-1; n >= 0; n--) {
-            QString myline = list.at(n); //+"\n";
-            int pos = rx.indexIn(myline);
-            pos &= rx2.indexIn(myline);
-            pos &= rxwc.indexIn(myline);
-            pos &= rxwcu.indexIn(myline);
-            pos &= rxfs.indexIn(myline);
-            pos &= rxw3.indexIn(myline);
-            if(pos > -1)
-                return n;
-            if(myline.contains(rspec))
-                return n;
+    /* ctags search patterns are literal text between /^ and $/
+     * with / and \ escaped, so a plain text search finds them.
+     */
+    if(rspec.indexOf('^') > -1)
+        rspec = rspec.mid(rspec.indexOf('^')+1);
+    if(rspec.lastIndexOf('$') > 0)
+        rspec = rspec.mid(0,rspec.lastIndexOf('$'));
+    rspec = rspec.replace("\\","");
+
+    QStringList list = filestr.split("\n");
+    /* searching backwards increases chance of finding
+     * the function definition instead of a declaration.
+     */
+    for(int n = list.length()-1; n >= 0; n--) {
+        if(list.at(n).contains(rspec)) {
+            rc = n;
+            break;
         }
-#endif
     }
 
+    TagLine tl;
+    tl.modified = info.lastModified();
+    tl.line = rc;
+    lineCache.insert(line, tl);
     return rc;
 }
 
@@ -32,6 +32,7 @@ public:
     int     runSpinCtags(QString path, QString libpath);
     bool    enabled();
     QString findTag(QString symbol);
+    QStringList findTags(QString prefix);
     QString getFile(QString line);
     int     getLine(QString line);
 
@@ -45,10 +46,10 @@ private:
     int     spintags(QString file);
     int     makeSpinTagMap(QString file, QMap<QString,QString> &map);
 
-private slots:
-    void    procError(QProcess::ProcessError);
-    void    procReadyRead();
-    void    procFinished(int,QProcess::ExitStatus);
+    bool    loadTags();
+    bool    tagsCurrent(QStringList args);
+    int     tagFiles(QStringList files);
+    bool    writeTags(QStringList files);
 
 private:
     bool        ctagsFound;
@@ -57,13 +58,32 @@ private:
     QString     projectPath;
     QString     libraryPath;
 
-    QProcess    *process;
-    bool        procDone;
-    QMutex      mutex;
-
     QString     tagFile;
     int         tagLine;
     QStringList tagStack;
+
+    /* symbol index of the project tags file */
+    QString     tagPath;
+    QDateTime   tagTime;
+    qint64      tagSize;
+    QHash<QString,QString>  tagMap;     // lower case symbol to first tags line
+    QStringList tagNames;               // sorted lower case symbols
+    QStringList lastArgs;
+
+    /* resolved search patterns, dropped when the file changes */
+    struct TagLine {
+        QDateTime   modified;
+        int         line;
+    };
+    QHash<QString,TagLine>  lineCache;  // tags line to line number
+
+    /* tags lines of each file ctags has read, kept until the file changes */
+    struct FileTags {
+        QDateTime   modified;
+        qint64      size;
+        QStringList lines;
+    };
+    QHash<QString,FileTags> fileTags;
 };
 
 #endif // CTAGS_H
@@ -18,8 +18,19 @@
  */
 
 #include "directory.h"
+#include "libraryindex.h"
 #include <QApplication>
 
+#if QT_VERSION < 0x050A00
+#ifdef Q_OS_WIN
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+#endif
+
+QHash<QString, Directory::IncludeList> Directory::includeCache;
+
 Directory::Directory()
 {
 }
@@ -50,19 +61,133 @@ bool Directory::isPossibleInfiniteFolder(QString spath, QString dpath)
     return dpath.contains(spath);
 }
 
-void Directory::recursiveCopyDir(QString srcdir, QString dstdir, QString notlist)
+/*
+ * Give a copied file the time stamp of its source.
+ */
+static bool setModifiedTime(const QString &fileName, const QDateTime &time)
 {
-    QString file;
+#if QT_VERSION >= 0x050A00
+    QFile file(fileName);
+    if(!file.open(QFile::ReadWrite))
+        return false;
+    return file.setFileTime(time, QFileDevice::FileModificationTime);
+#else
+    struct utimbuf times;
+    times.actime = time.toTime_t();
+    times.modtime = time.toTime_t();
+    return utime(QFile::encodeName(fileName).constData(), &times) == 0;
+#endif
+}
 
-    QStringList slist;
-    QStringList flist;
+/*
+ * A destination file is current if it has the same size and time stamp
+ * as the source. Copies get their source's time stamp, so this is only
+ * false for files that changed since. Times are compared in seconds,
+ * the resolution utime can set.
+ */
+bool Directory::isCopyCurrent(const QFileInfo &src, const QString &dst)
+{
+    QFileInfo dinfo(dst);
+    if(!dinfo.exists() || !dinfo.isFile())
+        return false;
+    if(dinfo.size() != src.size())
+        return false;
+    return dinfo.lastModified().toTime_t() == src.lastModified().toTime_t();
+}
+
+/*
+ * Walk the source tree once, create destination folders, and list the
+ * files that need copying.
+ */
+void Directory::collectCopyList(QString srcdir, QString dstdir, QStringList &filters,
+                                QStringList &srcList, QStringList &dstList)
+{
+    QDir spath(srcdir);
+    QDir dpath(dstdir);
+
+    if(dpath.exists() == false)
+        dpath.mkpath(dstdir);
+
+    QFileInfoList flist = spath.entryInfoList(QDir::Files);
+    foreach(QFileInfo info, flist) {
+        QString file = info.fileName();
+        if(isInFilterList(file,filters))
+            continue;
+        if(isCopyCurrent(info, dstdir+file))
+            continue;
+        srcList.append(srcdir+file);
+        dstList.append(dstdir+file);
+    }
+
+    QStringList slist = spath.entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
+    foreach(QString file, slist) {
+        if(isInFilterList(file,filters) == false)
+            collectCopyList(srcdir+file+"/", dstdir+file+"/", filters, srcList, dstList);
+    }
+}
 
+/*
+ * Results shared by the copy tasks of one recursiveCopyDir.
+ */
+struct CopyResults
+{
+    QSemaphore  done;
+    QAtomicInt  copied;
+    QMutex      mutex;
+    QStringList failed;
+};
+
+/*
+ * Copies one file on a thread pool worker. The copy is made beside the
+ * destination first so a failed copy leaves the old file in place.
+ */
+class CopyTask : public QRunnable
+{
+public:
+    CopyTask(const QString &src, const QString &dst, CopyResults *results)
+        : src(src), dst(dst), results(results)
+    {
+    }
+
+    void run()
+    {
+        QString part = dst+".part";
+        if(QFile::exists(part))
+            QFile::remove(part);
+        bool ok = QFile::copy(src, part);
+        if(ok) {
+            setModifiedTime(part, QFileInfo(src).lastModified());
+            if(QFile::exists(dst))
+                QFile::remove(dst);
+            ok = QFile::rename(part, dst);
+        }
+        if(ok) {
+            results->copied.fetchAndAddOrdered(1);
+        }
+        else {
+            QFile::remove(part);
+            QMutexLocker locker(&results->mutex);
+            results->failed.append(dst);
+        }
+        results->done.release();
+    }
+
+private:
+    QString src;
+    QString dst;
+    CopyResults *results;
+};
+
+/*
+ * Copy srcdir into dstdir skipping files matching notlist and files that
+ * are already current. Returns the number of files copied.
+ */
+int Directory::recursiveCopyDir(QString srcdir, QString dstdir, QString notlist, Progress *progress)
+{
     if(srcdir.length() < 1)
-        return;
+        return 0;
     if(dstdir.length() < 1)
-        return;
-
-    QApplication::processEvents();
+        return 0;
 
     QStringList list;
     if(notlist.isEmpty() == false)
@@ -73,39 +198,42 @@ void Directory::recursiveCopyDir(QString srcdir, QString dstdir, QString notlist
     if(dstdir.at(dstdir.length()-1) != '/')
         dstdir += '/';
 
-    QDir spath(srcdir);
-    QDir dpath(dstdir);
-
-    if(spath.exists() == false)
-        return;
+    if(QDir(srcdir).exists() == false)
+        return 0;
     if(isPossibleInfiniteFolder(srcdir, dstdir))
-        return;
-    if(dpath.exists() == false)
-        dpath.mkdir(dstdir);
+        return 0;
 
-    flist = spath.entryList(QDir::AllEntries, QDir::DirsLast);
-    foreach(file, flist) {
-        if(file.compare(".") == 0)
-            break;
-        if(file.compare("..") == 0)
-            break;
+    QStringList srcList;
+    QStringList dstList;
+    collectCopyList(srcdir, dstdir, list, srcList, dstList);
+
+    int total = srcList.count();
+    if(total == 0)
+        return 0;
+
+    CopyResults results;
+    QThreadPool pool;
+    for(int n = 0; n < total; n++)
+        pool.start(new CopyTask(srcList[n], dstList[n], &results));
+
+    int finished = 0;
+    while(finished < total) {
+        if(results.done.tryAcquire(1, 50))
+            finished++;
+        while(results.done.tryAcquire(1))
+            finished++;
+        if(progress != NULL)
+            progress->copyProgress(dstList[finished > 0 ? finished-1 : 0], finished, total);
         QApplication::processEvents();
-        if(isInFilterList(file,list) == false) {
-            if(QFile::exists(dstdir+file)) {
-                QFile::remove(dstdir+file);
-            }
-            QFile::copy(srcdir+file, dstdir+file);
-        }
     }
-    slist = spath.entryList(QDir::AllDirs, QDir::DirsLast);
-    foreach(file, slist) {
-        if(file.compare(".") == 0)
-            continue;
-        if(file.compare("..") == 0)
-            continue;
-        if(isInFilterList(file,list) == false)
-            recursiveCopyDir(srcdir+file, dstdir+file, notlist);
+    pool.waitForDone();
+
+    if(results.failed.count() > 0) {
+        qDebug() << "recursiveCopyDir failed" << results.failed;
+        if(progress != NULL)
+            progress->copyFailed(results.failed);
     }
+    return results.copied.fetchAndAddOrdered(0);
 }
 
 /*
@@ -218,7 +346,7 @@ QString Directory::find(QString file, QString find)
 {
     QFile ofile(file);
     if(ofile.open(QFile::ReadOnly)) {
-        QTextStream in(&file);
+        QTextStream in(&ofile);
         QString data = in.readAll();
         ofile.close();
         if(data.contains(find))
@@ -227,6 +355,117 @@ QString Directory::find(QString file, QString find)
     return QString("");
 }
 
+/*
+ * Return the names of files included by a C source. The result is kept
+ * until the file's size or time stamp changes.
+ */
+QStringList Directory::findCIncludes(QString fileName)
+{
+    QFileInfo info(fileName);
+    if(info.exists() == false) {
+        includeCache.remove(fileName);
+        return QStringList();
+    }
+
+    qint64 modified = info.lastModified().toMSecsSinceEpoch();
+    if(includeCache.contains(fileName)) {
+        const IncludeList &cached = includeCache[fileName];
+        if(cached.modified == modified && cached.size == info.size())
+            return cached.includes;
+    }
+
+    QFile file(fileName);
+    if(!file.open(QFile::ReadOnly))
+        return QStringList();
+    QByteArray data = file.readAll();
+    file.close();
+
+    IncludeList entry;
+    entry.modified = modified;
+    entry.size = info.size();
+    entry.includes = scanCIncludes(data);
+    includeCache.insert(fileName, entry);
+    return entry.includes;
+}
+
+/*
+ * One pass over the source. Comments, string and character literals are
+ * skipped, and only a # that starts a line can begin an #include.
+ * Conditional blocks are not evaluated.
+ */
+QStringList Directory::scanCIncludes(const QByteArray &data)
+{
+    QStringList list;
+    const char *p = data.constData();
+    const char *end = p + data.length();
+    bool linestart = true;
+
+    while(p < end) {
+        char c = *p;
+        if(c == '\n') {
+            linestart = true;
+            p++;
+        }
+        else if(c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v') {
+            p++;
+        }
+        else if(c == '\\' && p+1 < end && (p[1] == '\n' || p[1] == '\r')) {
+            // line splice
+            p += 2;
+            if(p[-1] == '\r' && p < end && *p == '\n')
+                p++;
+        }
+        else if(c == '/' && p+1 < end && p[1] == '*') {
+            p += 2;
+            while(p+1 < end && !(p[0] == '*' && p[1] == '/'))
+                p++;
+            p = (p+1 < end) ? p+2 : end;
+        }
+        else if(c == '/' && p+1 < end && p[1] == '/') {
+            while(p < end && *p != '\n') {
+                if(*p == '\\' && p+1 < end && p[1] == '\n')
+                    p++;
+                p++;
+            }
+        }
+        else if(c == '"' || c == '\'') {
+            p++;
+            while(p < end && *p != c && *p != '\n') {
+                if(*p == '\\' && p+1 < end)
+                    p++;
+                p++;
+            }
+            if(p < end && *p == c)
+                p++;
+            linestart = false;
+        }
+        else if(c == '#' && linestart) {
+            p++;
+            linestart = false;
+            while(p < end && (*p == ' ' || *p == '\t'))
+                p++;
+            if(end-p < 7 || qstrncmp(p, "include", 7) != 0)
+                continue;
+            p += 7;
+            while(p < end && (*p == ' ' || *p == '\t'))
+                p++;
+            if(p >= end || (*p != '"' && *p != '<'))
+                continue;
+            char close = (*p == '<') ? '>' : '"';
+            const char *start = ++p;
+            while(p < end && *p != close && *p != '\n')
+                p++;
+            if(p < end && *p == close && p > start)
+                list.append(QString::fromLocal8Bit(start, p-start));
+        }
+        else {
+            linestart = false;
+            p++;
+        }
+    }
+    return list;
+}
+
 #if 1
 bool Directory::isCSourceCommented(QString find, QString line, int num, QStringList lines)
 {
@@ -377,6 +616,11 @@ QString Directory::recursiveFindFile(QString dir, QString findfile)
     if(dir.length() < 1)
         return file;
 
+    // indexed trees are answered from memory
+    LibraryIndex *index = LibraryIndex::shared();
+    if(index->covers(dir))
+        return index->findFile(dir, findfile);
+
     QChar sep = dir.at(dir.length()-1);
     if(sep != '/' && sep != '\\')
         dir += "/";
@@ -417,6 +661,11 @@ int Directory::recursiveFindFileList(QString dir, QString findfile, QStringList
     if(dir.length() < 1)
         return 0;
 
+    // indexed trees are answered from memory
+    LibraryIndex *index = LibraryIndex::shared();
+    if(index->covers(dir))
+        return index->findFileList(dir, findfile, filelist);
+
     QChar sep = dir.at(dir.length()-1);
     if(sep != '/' && sep != '\\')
         dir += "/";
@@ -27,18 +27,41 @@ class Directory
 public:
     Directory();
 
+    /*
+     * Receives copy progress from recursiveCopyDir.
+     */
+    class Progress
+    {
+    public:
+        virtual ~Progress() {}
+        virtual void copyProgress(const QString &fileName, int copied, int total) = 0;
+        virtual void copyFailed(const QStringList &fileNames) { Q_UNUSED(fileNames); }
+    };
+
     static bool isInFilterList(QString file, QStringList list);
     static bool isPossibleInfiniteFolder(QString spath, QString dpath);
-    static void recursiveCopyDir(QString srcdir, QString dstdir, QString notlist = "");
+    static int recursiveCopyDir(QString srcdir, QString dstdir, QString notlist = "", Progress *progress = 0);
     static void recursiveRemoveDirSpecial(QString dir, QString parent);
     static void recursiveRemoveDir(QString dir);
     static QString find(QString file, QString find);
     static QStringList findCSourceList(QString file, QString find);
+    static QStringList findCIncludes(QString fileName);
     static QString recursiveFind(QString dir, QString find);
     static QString recursiveFindFile(QString dir, QString file);
     static int recursiveFindFileList(QString dir, QString findfile, QStringList &filelist);
 
 private:
+    struct IncludeList {
+        qint64      modified;
+        qint64      size;
+        QStringList includes;
+    };
+    static QHash<QString, IncludeList> includeCache;
+    static QStringList scanCIncludes(const QByteArray &data);
+
+    static bool isCopyCurrent(const QFileInfo &src, const QString &dst);
+    static void collectCopyList(QString srcdir, QString dstdir, QStringList &filters,
+                                QStringList &srcList, QStringList &dstList);
     static bool isCSourceCommented(QString find, QString line, int num, QStringList lines);
 
 };
@@ -19,6 +19,7 @@
 
 #include "linenumberarea.h"
 #include "editor.h"
+#include "buildoutput.h"
 #include "properties.h"
 
 #include "highlightc.h"
@@ -32,13 +33,13 @@
 #define MAINWINDOW MainWindow
 #endif
 
-Editor::Editor(GDB *gdebug, SpinParser *parser, QWidget *parent) : QPlainTextEdit(parent)
+Editor::Editor(GDB *gdebug, SpinIndex *index, QWidget *parent) : QPlainTextEdit(parent)
 {
     mainwindow = parent;
     ctrlPressed = false;
     setMouseTracking(true);
     gdb = gdebug;
-    spinParser = parser;
+    spinIndex = index;
     isSpin = false;
 
     lineNumberArea = new LineNumberArea(this);
@@ -79,6 +80,18 @@ void Editor::setHighlights(QString filename)
     }
 }
 
+/*
+ * Lines (from 1) to mark in the line number area
+ * with a BuildOutput::Severity. Kept until the next build.
+ */
+void Editor::setLineMarks(const QHash<int,int> &marks)
+{
+    if(marks.isEmpty() && lineMarks.isEmpty())
+        return;
+    lineMarks = marks;
+    lineNumberArea->update();
+}
+
 void Editor::setLineNumber(int num)
 {
     QTextCursor cur = textCursor();
@@ -349,37 +362,16 @@ int Editor::autoEnterColumnSpin()
 }
 
 
+/*
+ * The highlighter keeps comment state in each block, so this only
+ * looks at the block for the line.
+ */
 bool Editor::isCommentOpen(int line)
 {
-    // find out if there is a brace mismatch
-    QString s = this->toPlainText();
-    QStringList sl = s.split("\n",QString::SkipEmptyParts);
-    int length = sl.length();
-
-    int como = 0;
-    int comc = 0;
-
-    int lpos = -1;
-    int cpos = -1;
-
-    for(int n = 0; n < length; n++) {
-        s = sl.at(n);
-        if(s.contains("/*")) {
-            como++;
-        }
-        if(s.contains("*/")) {
-            comc++;
-        }
-        cpos = s.lastIndexOf("*");
-        if(line == n && como > comc) {
-            if(lpos > -1 && cpos == lpos) {
-                return true;
-            }
-        }
-        lpos = cpos;
-
-    }
-    return !(como == comc);
+    if(highlighter == NULL)
+        return false;
+    QTextBlock block = this->document()->findBlockByNumber(line);
+    return block.isValid() && Highlighter::blockComment(block) != 0;
 }
 
 int Editor::braceMatchColumn()
@@ -401,52 +393,12 @@ int Editor::braceMatchColumn()
     if(text.contains("{"))
         return 0;
 
-    // find out if there is a brace mismatch
-    QString s = this->toPlainText();
-
-    //QStringList sl = this->toPlainText().split(QRegExp("/\\*.*\\*/"));
-    //qDebug() << s;
-    //s = sl.join("\n");
-    //qDebug() << s;
-    QStringList sl = s.split("\n",QString::SkipEmptyParts);
-    int length = sl.length();
-
-    int braceo = 0;
-    int bracec = 0;
-
-    bool blockComment = false;
-
-    for(int n = 0; n < length; n++) {
-        QString s = sl.at(n);
-        if(s.contains("/*") && s.contains("*/")) {
-            QString t = s.mid(s.indexOf("*/")+2);
-            s = s.mid(0, s.indexOf("/*"));
-            s += t;
-        }
-        if(blockComment && s.contains("*/")) {
-            s = s.mid(s.indexOf("*/")+2);
-            blockComment = false;
-        }
-        if(blockComment)
-            continue;
-        if(s.contains("/*") && !s.contains("*/")) {
-            s = s.mid(0, s.indexOf("/*"));
-            blockComment = true;
-        }
-        //qDebug() << "BMATCH" << s;
-
-        if(s.contains("{")) {
-            braceo++;
-        }
-        if(s.contains("}")) {
-            bracec++;
-        }
-    }
-
-    // if all braces match exit
-    if(braceo == bracec) {
+    /* the highlighter keeps the brace count of the whole document */
+    if(highlighter == NULL)
         return 0;
-    }
+    if(highlighter->braceDepth() <= 0)
+        return 0;
+
     qDebug() << "Brace Mismatch";
 
     // if brace mismatch, set closing brace
@@ -640,7 +592,7 @@ int Editor::spinAutoComplete()
         disconnect(&cbAuto,SIGNAL(activated(int)),this,SLOT(cbAutoSelected0insert(int)));
         connect(&cbAuto, SIGNAL(activated(int)), this, SLOT(cbAutoSelected0insert(int)));
         qDebug() << "keyPressEvent object dot pressed" << text;
-        QStringList list = spinParser->spinSymbols(fileName,text);
+        QStringList list = spinIndex->symbols(fileName,text);
         if(list.count() == 0)
             return 0;
         cbAuto.clear();
@@ -685,7 +637,7 @@ int Editor::spinAutoComplete()
         disconnect(&cbAuto,SIGNAL(activated(int)),this,SLOT(cbAutoSelected0insert(int)));
         connect(&cbAuto, SIGNAL(activated(int)), this, SLOT(cbAutoSelected(int)));
         qDebug() << "keyPressEvent local dot pressed";
-        QStringList list = spinParser->spinSymbols(fileName,"");
+        QStringList list = spinIndex->symbols(fileName,"");
         if(list.count() == 0)
             return 0;
         cbAuto.clear();
@@ -734,7 +686,7 @@ int  Editor::spinAutoCompleteCON()
         disconnect(&cbAuto,SIGNAL(activated(int)),this,SLOT(cbAutoSelected0insert(int)));
         connect(&cbAuto, SIGNAL(activated(int)), this, SLOT(cbAutoSelected0insert(int)));
         qDebug() << "keyPressEvent # pressed" << text;
-        QStringList list = spinParser->spinConstants(fileName,text);
+        QStringList list = spinIndex->constants(fileName,text);
         if(list.count() == 0)
             return 0;
         cbAuto.clear();
@@ -763,7 +715,7 @@ int  Editor::spinAutoCompleteCON()
         disconnect(&cbAuto,SIGNAL(activated(int)),this,SLOT(cbAutoSelected0insert(int)));
         connect(&cbAuto, SIGNAL(activated(int)), this, SLOT(cbAutoSelected(int)));
         qDebug() << "keyPressEvent local # pressed";
-        QStringList list = spinParser->spinConstants(fileName,"");
+        QStringList list = spinIndex->constants(fileName,"");
         if(list.count() == 0)
             return 0;
         cbAuto.clear();
@@ -1063,6 +1015,11 @@ void Editor::lineNumberAreaPaintEvent(QPaintEvent *event)
 //![extraAreaPaintEvent_2]
     while (block.isValid() && top <= event->rect().bottom()) {
         if (block.isVisible() && bottom >= event->rect().top()) {
+            if (lineMarks.contains(blockNumber + 1)) {
+                QColor mark = lineMarks[blockNumber + 1] == BuildOutput::Error ?
+                              QColor(255, 160, 160) : QColor(255, 220, 140);
+                painter.fillRect(0, top, lineNumberArea->width(), bottom - top, mark);
+            }
             QString number = QString::number(blockNumber + 1);
             painter.setPen(Qt::darkGray);
             painter.drawText(0, top, lineNumberArea->width(), fontMetrics().height(),
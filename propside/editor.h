@@ -22,7 +22,7 @@
 
 #include "gdb.h"
 #include "highlighter.h"
-#include "spinparser.h"
+#include "spinindex.h"
 
 class LineNumberArea;
 
@@ -30,11 +30,12 @@ class Editor : public QPlainTextEdit
 {
     Q_OBJECT
 public:
-    Editor(GDB *gdb, SpinParser *parser, QWidget *parent);
+    Editor(GDB *gdb, SpinIndex *index, QWidget *parent);
     virtual ~Editor();
 
     void setHighlights(QString filename = "");
     void setLineNumber(int num);
+    void setLineMarks(const QHash<int,int> &marks);
 
     void clearCtrlPressed();
 
@@ -67,7 +68,7 @@ private:
     QPoint  mousepos;
     bool    ctrlPressed;
     GDB     *gdb;
-    SpinParser  *spinParser;
+    SpinIndex   *spinIndex;
     bool    isSpin;
     Highlighter *highlighter;
 
@@ -92,6 +93,7 @@ private slots:
     
 private:
     QWidget *lineNumberArea;
+    QHash<int,int> lineMarks;
     QString fileName;
 
 signals:
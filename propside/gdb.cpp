@@ -19,6 +19,7 @@
 
 #include "gdb.h"
 #include "Sleeper.h"
+#include "toolrunner.h"
 
 #define GDBPROMPT "(gdb)"
 
@@ -57,10 +58,10 @@ void GDB::load(QString program, QString workpath, QString target, QString image,
 
     status->setPlainText("");
     status->insertPlainText(tr("Starting gdb ... "));
+    ToolRunner runner(process);
     process->start(program,args);
 
-    while(gdbRunning == false)
-        QApplication::processEvents();
+    runner.wait(&gdbRunning);
 
     //sendCommand("set listsize 1");
     //sendCommand("target remote | " + target); // + " -v -l gdblog.txt");
@@ -89,8 +90,10 @@ void GDB::sendCommand(QString command)
         return;
     }
 
-    while(gdbReady == false)
-        QApplication::processEvents();
+    ToolRunner runner(process);
+    runner.wait(&gdbReady);
+    if(gdbRunning == false)
+        return;
 
     setReady(false);
     command += "\n";
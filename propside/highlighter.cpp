@@ -51,7 +51,7 @@
 
 //! [0]
 Highlighter::Highlighter(QTextDocument *parent, Properties *prop)
-    : QSyntaxHighlighter(parent)
+    : QSyntaxHighlighter(parent), braceTotal(new int(0))
 {
     properties = prop;
     highlight();
@@ -158,9 +158,255 @@ void Highlighter::highlight()
 
 }
 
+void Highlighter::addWords(const QStringList &words, int wordClass)
+{
+    foreach (const QString &word, words) {
+        wordTable.insert(syntax.caseless ? word.toUpper() : word, wordClass);
+    }
+}
+
+static bool startsAt(const QString &text, int pos, const QString &token)
+{
+    int len = token.length();
+    if(len == 0 || pos + len > text.length())
+        return false;
+    const QChar *s = text.unicode() + pos;
+    const QChar *t = token.unicode();
+    for(int n = 0; n < len; n++) {
+        if(s[n] != t[n])
+            return false;
+    }
+    return true;
+}
+
+static inline bool isWordChar(QChar c)
+{
+    ushort u = c.unicode();
+    return (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') ||
+           (u >= '0' && u <= '9') || u == '_';
+}
+
+static inline bool isHexChar(QChar c)
+{
+    ushort u = c.unicode();
+    return (u >= '0' && u <= '9') || (u >= 'a' && u <= 'f') ||
+           (u >= 'A' && u <= 'F') || u == '_';
+}
+
+/*
+ * Format one word of a line: numbers start with a digit, everything
+ * else is looked up once in the keyword table.
+ */
+void Highlighter::lexWord(const QString &text, int start, int length)
+{
+    ushort u = text.at(start).unicode();
+    if(u >= '0' && u <= '9') {
+        setFormat(start, length, numberFormat);
+        return;
+    }
+    QString word = text.mid(start, length);
+    int wordClass = wordTable.value(syntax.caseless ? word.toUpper() : word, WordNone);
+    if(wordClass == WordKeyword)
+        setFormat(start, length, keywordFormat);
+    else if(wordClass == WordPreProc)
+        setFormat(start, length, preprocessorFormat);
+}
+
+/*
+ * The block state only keeps the open comment, so an edit carries on
+ * to following blocks only when it opens or closes a comment.
+ */
+int Highlighter::blockComment(const QTextBlock &block)
+{
+    int state = block.userState();
+    return (state < 0) ? 0 : (state & BLOCK_COMMENT_MASK);
+}
+
+/*
+ * Single pass over the block. Strings and comments are opaque so
+ * keywords inside them are not highlighted. Comment state 1 is an open
+ * block comment and 2 is an open doc comment.
+ */
+void Highlighter::lexBlock(const QString &text)
+{
+    const QChar *s = text.unicode();
+    int len = text.length();
+    int pos = 0;
+    int state = previousBlockState();
+    int comment = 0;
+    int braces = 0;
+
+    if(state > 0)
+        comment = state & BLOCK_COMMENT_MASK;
+
+    if(comment != 0) {
+        const QString &end = (comment == 2) ? syntax.docEnd : syntax.blockEnd;
+        int close = text.indexOf(end);
+        if(close < 0) {
+            setFormat(0, len, multiLineCommentFormat);
+            pos = len;
+        }
+        else {
+            pos = close + end.length();
+            setFormat(0, pos, multiLineCommentFormat);
+            comment = 0;
+        }
+    }
+
+    bool directive = false;
+    bool leading = (pos == 0);
+
+    while(pos < len) {
+        QChar c = s[pos];
+        ushort u = c.unicode();
+
+        if(c.isSpace()) {
+            pos++;
+            continue;
+        }
+        if(leading) {
+            directive = (u == '#');
+            leading = false;
+        }
+
+        if(startsAt(text, pos, syntax.lineComment)) {
+            setFormat(pos, len-pos, singleLineCommentFormat);
+            break;
+        }
+
+        int open = 0;
+        if(startsAt(text, pos, syntax.docStart))
+            open = 2;
+        else if(startsAt(text, pos, syntax.blockStart))
+            open = 1;
+        if(open) {
+            const QString &start = (open == 2) ? syntax.docStart : syntax.blockStart;
+            const QString &end = (open == 2) ? syntax.docEnd : syntax.blockEnd;
+            int close = text.indexOf(end, pos + start.length());
+            if(close < 0) {
+                setFormat(pos, len-pos, multiLineCommentFormat);
+                comment = open;
+                break;
+            }
+            setFormat(pos, close + end.length() - pos, multiLineCommentFormat);
+            pos = close + end.length();
+            continue;
+        }
+
+        if(u == '"') {
+            int end = pos+1;
+            while(end < len && s[end] != QLatin1Char('"')) {
+                if(syntax.escapes && s[end] == QLatin1Char('\\'))
+                    end++;
+                end++;
+            }
+            if(end < len) {
+                setFormat(pos, end+1-pos, quotationFormat);
+                pos = end+1;
+                continue;
+            }
+        }
+
+        if(u == '\'' && syntax.escapes) {
+            int end = pos+1;
+            while(end < len && s[end] != QLatin1Char('\'')) {
+                if(s[end] == QLatin1Char('\\'))
+                    end++;
+                end++;
+            }
+            pos = end+1;
+            continue;
+        }
+
+        if(u == '<' && directive && syntax.angleIncludes) {
+            int end = text.indexOf(QLatin1Char('>'), pos+1);
+            if(end > pos+1 && isWordChar(s[pos+1])) {
+                setFormat(pos, end+1-pos, quotationFormat);
+                pos = end+1;
+                continue;
+            }
+        }
+
+        if(!syntax.hexPrefix.isNull() && c == syntax.hexPrefix) {
+            int end = pos+1;
+            while(end < len && isHexChar(s[end]))
+                end++;
+            setFormat(pos, end-pos, numberFormat);
+            pos = end;
+            continue;
+        }
+
+        if(isWordChar(c)) {
+            int end = pos;
+            while(end < len && isWordChar(s[end]))
+                end++;
+            int call = end;
+            if(syntax.dottedCalls) {
+                while(call+1 < len && s[call] == QLatin1Char('.') && isWordChar(s[call+1])) {
+                    call++;
+                    while(call < len && isWordChar(s[call]))
+                        call++;
+                }
+            }
+            if(call < len && s[call] == QLatin1Char('(')) {
+                setFormat(pos, call-pos, functionFormat);
+                end = call;
+            }
+            /* keywords and numbers override function names */
+            int word = pos;
+            while(word < end) {
+                int next = word;
+                while(next < end && isWordChar(s[next]))
+                    next++;
+                lexWord(text, word, next-word);
+                word = next+1;
+            }
+            pos = end;
+            continue;
+        }
+
+        if(syntax.minOperator > 0 && syntax.operators.contains(c)) {
+            int end = pos+1;
+            if(syntax.minOperator > 1) {
+                while(end < len && s[end] == c)
+                    end++;
+            }
+            else {
+                while(end < len && syntax.operators.contains(s[end]))
+                    end++;
+            }
+            if(end - pos >= syntax.minOperator)
+                setFormat(pos, end-pos, keywordFormat);
+            pos = end;
+            continue;
+        }
+
+        if(syntax.braces) {
+            if(u == '{')
+                braces++;
+            else if(u == '}')
+                braces--;
+        }
+        pos++;
+    }
+
+    setCurrentBlockState(comment);
+
+    if(syntax.braces) {
+        BraceData *data = static_cast<BraceData*>(currentBlockUserData());
+        if(data == NULL || data->total != braceTotal || data->delta != braces)
+            setCurrentBlockUserData(new BraceData(braceTotal, braces));
+    }
+}
+
 //! [7]
 void Highlighter::highlightBlock(const QString &text)
 {
+    if(wordTable.count() > 0) {
+        lexBlock(text);
+        return;
+    }
+
     int rules = 0;
     foreach (const HighlightingRule &rule, highlightingRules) {
         rules++;
@@ -51,10 +51,28 @@
 #include <QSyntaxHighlighter>
 
 #include <QHash>
+#include <QSharedPointer>
+#include <QTextBlock>
 #include <QTextCharFormat>
 
 #include "properties.h"
 
+#define BLOCK_COMMENT_MASK  3
+
+/*
+ * Net count of { less } in one block. The document total changes with
+ * the block's data, so it follows edits, re-lexed and deleted blocks.
+ */
+class BraceData : public QTextBlockUserData
+{
+public:
+    BraceData(QSharedPointer<int> sum, int count) : total(sum), delta(count) { *total += delta; }
+    ~BraceData() { *total -= delta; }
+
+    QSharedPointer<int> total;
+    int delta;
+};
+
 QT_BEGIN_NAMESPACE
 class QTextDocument;
 QT_END_NAMESPACE
@@ -74,6 +92,10 @@ public:
 
     virtual void highlight();
 
+    /* unmatched { in the whole document */
+    int braceDepth() const { return *braceTotal; }
+    static int blockComment(const QTextBlock &block);
+
 protected:
     void highlightBlock(const QString &text);
 
@@ -84,6 +106,38 @@ protected:
     };
     QVector<HighlightingRule> highlightingRules;
 
+    /*
+     * Languages that fill in wordTable get a single pass lexer instead
+     * of the rule loop. Each token is classified once against the table.
+     */
+    enum WordClass { WordNone, WordKeyword, WordPreProc };
+
+    struct LexerSyntax
+    {
+        LexerSyntax() : caseless(false), dottedCalls(false), escapes(false),
+            angleIncludes(false), braces(false), minOperator(0) {}
+        bool    caseless;       // words are stored upper case
+        bool    dottedCalls;    // obj.method( is one function name
+        bool    escapes;        // backslash escapes inside strings
+        bool    angleIncludes;  // <file> is a string on # lines
+        bool    braces;         // keep { } counts in BraceData
+        int     minOperator;    // 1 = any run, >1 = same char repeated
+        QChar   hexPrefix;
+        QString operators;
+        QString lineComment;
+        QString blockStart;
+        QString blockEnd;
+        QString docStart;
+        QString docEnd;
+    };
+    LexerSyntax syntax;
+    QHash<QString,int> wordTable;
+    QSharedPointer<int> braceTotal;
+
+    void addWords(const QStringList &words, int wordClass);
+    void lexBlock(const QString &text);
+    void lexWord(const QString &text, int start, int length);
+
     QRegExp commentStartExpression;
     QRegExp commentEndExpression;
 
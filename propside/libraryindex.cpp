@@ -0,0 +1,381 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "libraryindex.h"
+#include "directory.h"
+
+#define LIBRARYINDEX_MAGIC      0x534c4958  // "SLIX"
+#define LIBRARYINDEX_VERSION    1
+
+// most folders to watch. deeper changes are found by refresh
+#define WATCH_LIMIT     64
+// how long lookups trust the index without a refresh
+#define REFRESH_MSECS   2000
+
+LibraryIndex::LibraryIndex(QObject *parent) : QObject(parent)
+{
+    dirty = false;
+    stale = true;
+    connect(&watcher, SIGNAL(directoryChanged(QString)), this, SLOT(directoryChanged(QString)));
+}
+
+/*
+ * The application wide index used by the Directory helpers.
+ */
+LibraryIndex *LibraryIndex::shared()
+{
+    static LibraryIndex *index = NULL;
+    if(index == NULL)
+        index = new LibraryIndex(QCoreApplication::instance());
+    return index;
+}
+
+void LibraryIndex::directoryChanged(const QString &path)
+{
+    Q_UNUSED(path);
+    stale = true;
+}
+
+/*
+ * Make rootdir the indexed tree. The saved index is loaded the first time,
+ * then every call brings it up to date with the file system.
+ */
+bool LibraryIndex::open(QString rootdir)
+{
+    if(rootdir.isEmpty())
+        return false;
+    QChar sep = rootdir.at(rootdir.length()-1);
+    if(sep != '/' && sep != '\\')
+        rootdir += "/";
+
+    if(rootdir.compare(root) != 0) {
+        root = rootdir;
+        dirs.clear();
+        names.clear();
+        suffixes.clear();
+        stale = true;
+
+        QFile file(indexFileName());
+        if(file.open(QFile::ReadOnly)) {
+            QDataStream in(&file);
+            quint32 magic = 0;
+            qint32 version = 0;
+            QString saved;
+            in >> magic >> version >> saved;
+            if(magic == LIBRARYINDEX_MAGIC && version == LIBRARYINDEX_VERSION && saved.compare(root) == 0) {
+                qint32 count = 0;
+                in >> count;
+                for(int n = 0; n < count && in.status() == QDataStream::Ok; n++) {
+                    QString rel;
+                    DirEntry entry;
+                    in >> rel >> entry.modified >> entry.entries >> entry.dirs;
+                    dirs.insert(rel, entry);
+                }
+                if(in.status() != QDataStream::Ok)
+                    dirs.clear();
+                else
+                    indexNames("");
+            }
+            file.close();
+        }
+    }
+
+    if(refreshDue()) {
+        if(refresh() > 0)
+            save();
+    }
+    return dirs.count() > 0;
+}
+
+bool LibraryIndex::refreshDue()
+{
+    return stale || lastRefresh.isNull() || lastRefresh.elapsed() > REFRESH_MSECS;
+}
+
+/*
+ * Re-read changed directories. Returns the number of directories
+ * that were added, removed, or re-listed.
+ */
+int LibraryIndex::refresh()
+{
+    int changed = 0;
+    if(root.isEmpty())
+        return 0;
+
+    stale = false;
+    lastRefresh.start();
+    if(QFileInfo(root).isDir() == false) {
+        changed = dirs.count();
+        dirs.clear();
+        names.clear();
+        suffixes.clear();
+        dirty = changed > 0;
+        watchDirs();
+        return changed;
+    }
+
+    QSet<QString> seen;
+    refreshDir("", seen, changed);
+
+    foreach(QString rel, dirs.keys()) {
+        if(seen.contains(rel) == false) {
+            dirs.remove(rel);
+            changed++;
+        }
+    }
+
+    if(changed > 0) {
+        names.clear();
+        suffixes.clear();
+        indexNames("");
+        dirty = true;
+    }
+    if(changed > 0 || watcher.directories().isEmpty())
+        watchDirs();
+    return changed;
+}
+
+/*
+ * Watch the root and its top level folders, up to WATCH_LIMIT.
+ * Only paths that are not watched yet are added.
+ */
+void LibraryIndex::watchDirs()
+{
+    QStringList paths;
+    if(dirs.contains("")) {
+        paths.append(root.left(root.length()-1));
+        foreach(QString sub, dirs[""].dirs) {
+            if(paths.count() >= WATCH_LIMIT)
+                break;
+            paths.append(root+sub);
+        }
+    }
+
+    QStringList current = watcher.directories();
+    QStringList remove;
+    foreach(QString path, current) {
+        if(paths.contains(path) == false)
+            remove.append(path);
+    }
+    if(remove.count() > 0)
+        watcher.removePaths(remove);
+
+    QStringList add;
+    foreach(QString path, paths) {
+        if(current.contains(path) == false)
+            add.append(path);
+    }
+    if(add.count() > 0)
+        watcher.addPaths(add);
+}
+
+/*
+ * True if dir is inside the indexed tree. The index is refreshed first
+ * if a watched folder changed or the last refresh is too old.
+ */
+bool LibraryIndex::covers(QString dir)
+{
+    if(root.isEmpty() || dir.isEmpty())
+        return false;
+    QChar sep = dir.at(dir.length()-1);
+    if(sep != '/' && sep != '\\')
+        dir += "/";
+    if(dir.startsWith(root) == false)
+        return false;
+    if(refreshDue()) {
+        if(refresh() > 0)
+            save();
+    }
+    return dirs.contains(dir.mid(root.length()));
+}
+
+/*
+ * A directory's time changes when entries are added, removed, or renamed.
+ * That is all the index depends on, so unchanged directories cost one stat.
+ */
+void LibraryIndex::refreshDir(QString rel, QSet<QString> &seen, int &changed)
+{
+    seen.insert(rel);
+    QString path = root+rel;
+    qint64 modified = QFileInfo(path).lastModified().toMSecsSinceEpoch();
+
+    if(dirs.contains(rel) == false || dirs[rel].modified != modified) {
+        QDir dpath(path);
+        DirEntry entry;
+        entry.modified = modified;
+        entry.entries = dpath.entryList(QDir::AllEntries, QDir::DirsLast);
+        entry.dirs = dpath.entryList(QDir::AllDirs, QDir::DirsLast);
+        entry.entries.removeAll(".");
+        entry.entries.removeAll("..");
+        entry.dirs.removeAll(".");
+        entry.dirs.removeAll("..");
+        dirs.insert(rel, entry);
+        changed++;
+    }
+
+    QStringList subdirs = dirs[rel].dirs;
+    foreach(QString sub, subdirs) {
+        refreshDir(rel+sub+"/", seen, changed);
+    }
+}
+
+/*
+ * First match wins in the same order recursiveFindFile searches:
+ * a directory's own entries, then each subdirectory in turn.
+ */
+void LibraryIndex::indexNames(QString rel)
+{
+    if(dirs.contains(rel) == false)
+        return;
+    const DirEntry &entry = dirs[rel];
+    foreach(QString name, entry.entries) {
+        if(names.contains(name) == false)
+            names.insert(name, root+rel+name);
+        int dot = name.lastIndexOf('.');
+        if(dot > -1)
+            suffixes[name.mid(dot+1).toLower()].append(root+rel+name);
+    }
+    foreach(QString sub, entry.dirs) {
+        indexNames(rel+sub+"/");
+    }
+}
+
+QString LibraryIndex::findInDir(QString rel, QString name)
+{
+    const DirEntry &entry = dirs[rel];
+    if(entry.entries.contains(name))
+        return root+rel+name;
+    foreach(QString sub, entry.dirs) {
+        QString subrel = rel+sub+"/";
+        if(dirs.contains(subrel) == false)
+            continue;
+        QString val = findInDir(subrel, name);
+        if(val.isEmpty() == false)
+            return val;
+    }
+    return QString("");
+}
+
+/*
+ * Find name under dir. Directories outside the indexed tree
+ * fall back to walking the file system.
+ */
+QString LibraryIndex::findFile(QString dir, QString name)
+{
+    if(dir.isEmpty())
+        return QString("");
+    QChar sep = dir.at(dir.length()-1);
+    if(sep != '/' && sep != '\\')
+        dir += "/";
+
+    if(root.isEmpty() || dir.startsWith(root) == false)
+        return Directory::recursiveFindFile(dir, name);
+
+    QString rel = dir.mid(root.length());
+    if(dirs.contains(rel) == false)
+        return Directory::recursiveFindFile(dir, name);
+
+    if(rel.isEmpty())
+        return names.value(name);
+    return findInDir(rel, name);
+}
+
+void LibraryIndex::findListInDir(QString rel, QRegExp &regex, QStringList &filelist)
+{
+    const DirEntry &entry = dirs[rel];
+    foreach(QString name, entry.entries) {
+        if(name.indexOf(regex) > -1)
+            filelist.append(root+rel+name);
+    }
+    foreach(QString sub, entry.dirs) {
+        QString subrel = rel+sub+"/";
+        if(dirs.contains(subrel))
+            findListInDir(subrel, regex, filelist);
+    }
+}
+
+/*
+ * Append entries under dir matching the wildcard pattern in the order
+ * Directory::recursiveFindFileList finds them. A plain "*.ext" pattern
+ * is answered from the suffix table.
+ */
+int LibraryIndex::findFileList(QString dir, QString pattern, QStringList &filelist)
+{
+    if(dir.isEmpty())
+        return filelist.length();
+    QChar sep = dir.at(dir.length()-1);
+    if(sep != '/' && sep != '\\')
+        dir += "/";
+
+    QString rel = dir.mid(root.length());
+    if(root.isEmpty() || dir.startsWith(root) == false || dirs.contains(rel) == false)
+        return Directory::recursiveFindFileList(dir, pattern, filelist);
+
+    QString ext = pattern.mid(2);
+    if(pattern.startsWith("*.") && !ext.contains(QRegExp("[*?\\[.]"))) {
+        QStringList list = suffixes.value(ext.toLower());
+        foreach(QString path, list) {
+            if(path.startsWith(dir))
+                filelist.append(path);
+        }
+    }
+    else {
+        QRegExp regex(pattern, Qt::CaseInsensitive, QRegExp::Wildcard);
+        findListInDir(rel, regex, filelist);
+    }
+    return filelist.length();
+}
+
+bool LibraryIndex::save()
+{
+    if(!dirty || root.isEmpty())
+        return true;
+
+    QString fileName = indexFileName();
+    QDir().mkpath(QFileInfo(fileName).path());
+
+    QFile file(fileName);
+    if(!file.open(QFile::WriteOnly | QFile::Truncate))
+        return false;
+
+    QDataStream out(&file);
+    out << (quint32) LIBRARYINDEX_MAGIC << (qint32) LIBRARYINDEX_VERSION << root;
+    out << (qint32) dirs.count();
+    QHash<QString, DirEntry>::const_iterator it;
+    for(it = dirs.constBegin(); it != dirs.constEnd(); ++it) {
+        out << it.key() << it.value().modified << it.value().entries << it.value().dirs;
+    }
+    file.close();
+    dirty = false;
+    return true;
+}
+
+/*
+ * One index file per library tree in the application cache folder.
+ */
+QString LibraryIndex::indexFileName()
+{
+#ifdef QT5
+    QString path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+#else
+    QString path = QDesktopServices::storageLocation(QDesktopServices::CacheLocation);
+#endif
+    QByteArray id = QCryptographicHash::hash(root.toUtf8(), QCryptographicHash::Md5).toHex();
+    return path+"/libindex-"+QString(id)+".dat";
+}
@@ -0,0 +1,85 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRARYINDEX_H
+#define LIBRARYINDEX_H
+
+#include "qtversion.h"
+
+/*
+ * LibraryIndex remembers the directory listings of a library tree such as
+ * Learn/Simple Libraries so AutoLib can resolve "libname" folders and
+ * headers without walking the file system on every build.
+ *
+ * The index is saved in the user's cache folder. open() loads it and
+ * re-reads only directories whose modification time changed, so adding or
+ * removing a library costs one listing instead of a full tree walk.
+ * findFile() returns exactly what Directory::recursiveFindFile would.
+ *
+ * Only the root and its top level folders are watched, so the watcher
+ * needs a few file handles rather than one per folder. Changes deeper in
+ * the tree are found by the refresh, which the Directory::recursiveFind*
+ * helpers run at most every REFRESH_MSECS unless a watched folder changes.
+ */
+class LibraryIndex : public QObject
+{
+    Q_OBJECT
+public:
+    LibraryIndex(QObject *parent = 0);
+
+    static LibraryIndex *shared();
+
+    bool open(QString rootdir);
+    int  refresh();
+    bool save();
+
+    bool covers(QString dir);
+    QString rootPath() { return root; }
+    QString findFile(QString dir, QString name);
+    int findFileList(QString dir, QString pattern, QStringList &filelist);
+
+private slots:
+    void directoryChanged(const QString &path);
+
+private:
+    void refreshDir(QString rel, QSet<QString> &seen, int &changed);
+    void indexNames(QString rel);
+    void watchDirs();
+    bool refreshDue();
+    QString findInDir(QString rel, QString name);
+    void findListInDir(QString rel, QRegExp &regex, QStringList &filelist);
+    QString indexFileName();
+
+    struct DirEntry {
+        qint64      modified;
+        QStringList entries;
+        QStringList dirs;
+    };
+
+    QString root;
+    bool    dirty;
+    bool    stale;
+    QTime   lastRefresh;
+    QHash<QString, DirEntry> dirs;
+    QHash<QString, QString> names;
+    QHash<QString, QStringList> suffixes;
+    QFileSystemWatcher watcher;
+};
+
+#endif // LIBRARYINDEX_H
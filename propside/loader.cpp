@@ -20,6 +20,7 @@
 #include "loader.h"
 #include "properties.h"
 #include "Sleeper.h"
+#include "toolrunner.h"
 
 Loader::Loader(QLabel *mainstatus, QPlainTextEdit *compileStatus, QProgressBar *progressBar, QWidget *parent) :
     QPlainTextEdit(parent)
@@ -66,10 +67,10 @@ int Loader::load(QString program, QString workpath, QStringList args)
     this->setPlainText("");
     setReady(false);
     setDisableIO(false);
+    ToolRunner runner(process);
     process->start(this->program,args);
 
-    while(running == false)
-        QApplication::processEvents();
+    runner.wait(&running);
 
     return process->exitCode();
 }
@@ -108,10 +109,10 @@ int Loader::reload(QString port)
 
     setReady(false);
     setDisableIO(false);
+    ToolRunner runner(process);
     process->start(this->program,args);
 
-    while(running == false)
-        QApplication::processEvents();
+    runner.wait(&running);
 
     return process->exitCode();
 }
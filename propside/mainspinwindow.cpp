@@ -37,8 +37,10 @@
 #include "buildstatus.h"
 //#include "quazip.h"
 //#include "quazipfile.h"
-#include "PropellerID.h"
+#include "PropellerScan.h"
 #include "directory.h"
+#include "libraryindex.h"
+#include "toolrunner.h"
 
 #define ENABLE_ADD_LINK
 #define APP_FOLDER_TEMPLATES
@@ -133,7 +135,7 @@ void myMessageOutput(QtMsgType type, const char *msg)
 #endif
 
 MainSpinWindow::MainSpinWindow(QWidget *parent) : QMainWindow(parent),
-    compileStatusClickEnable(true), tabChangeDisable(false), fileChangeDisable(false)
+    compileStatusClickEnable(true), diagnosticIndex(-1), tabChangeDisable(false), fileChangeDisable(false)
 {
 #if defined(IDEDEBUG)
     debugStatus = new QPlainTextEdit(this);
@@ -319,6 +321,7 @@ MainSpinWindow::MainSpinWindow(QWidget *parent) : QMainWindow(parent),
 
     portConnectionMonitor = new PortConnectionMonitor();
     connect(portConnectionMonitor, SIGNAL(portChanged()), this, SLOT(enumeratePortsEvent()));
+    connect(portConnectionMonitor, SIGNAL(portChanged()), &propScan, SLOT(invalidate()));
 
     /* these are read once per app startup */
     QVariant lastportv  = settings->value(lastPortNameKey);
@@ -3861,6 +3864,7 @@ void MainSpinWindow::saveFile()
         if (file.open(QFile::WriteOnly)) {
             os << data;
             file.close();
+            editors->at(n)->document()->setModified(false);
         }
         if(saveas) {
             this->closeTab(n);
@@ -3890,6 +3894,7 @@ void MainSpinWindow::saveFileByTabIndex(int tab)
         if (file.open(QFile::WriteOnly)) {
             file.write(data.toUtf8());
             file.close();
+            editors->at(tab)->document()->setModified(false);
         }
     }
 }
@@ -4133,6 +4138,7 @@ void MainSpinWindow::downloadSdCard()
     process->setProperty("Name", QVariant(aSideLoader));
     process->setProperty("IsLoader", QVariant(true));
 
+    loaderOutput.startStream();
     connect(process, SIGNAL(readyReadStandardOutput()),this,SLOT(procReadyRead()));
     connect(process, SIGNAL(finished(int,QProcess::ExitStatus)),this,SLOT(procFinished(int,QProcess::ExitStatus)));
     connect(process, SIGNAL(error(QProcess::ProcessError)), this, SLOT(procError(QProcess::ProcessError)));
@@ -4144,16 +4150,16 @@ void MainSpinWindow::downloadSdCard()
     procDone = false;
     procMutex.unlock();
 
+    ToolRunner runner(process);
     process->start(aSideLoader,args);
 
     status->setText(status->text()+tr(" Loading ... "));
 
-    while(procDone == false)
-        QApplication::processEvents();
+    runner.wait(&procDone);
 
     if(process->state() == QProcess::Running) {
         process->kill();
-        Sleeper::ms(500);
+        process->waitForFinished(500);
         compileStatus->appendPlainText(tr("File to SD Card killed by user."));
         status->setText(status->text() + tr(" Done."));
     }
@@ -4178,6 +4184,12 @@ void MainSpinWindow::procFinished(int exitCode, QProcess::ExitStatus exitStatus)
     procDone = true;
     procMutex.unlock();
 
+    QString rest = loaderOutput.flush();
+    if(rest.length() > 0) {
+        compileStatus->moveCursor(QTextCursor::End);
+        compileStatus->insertPlainText("\n"+rest);
+    }
+
     QVariant name = process->property("Name");
     builder->buildResult(exitStatus, exitCode, name.toString(), process->readAllStandardOutput());
 
@@ -4460,81 +4472,42 @@ void MainSpinWindow::procReadyRead()
     QString eol("\n");
 #endif
 
-    qDebug() << bytes;
-    while (QString(bytes).contains("\r\n"))
-        bytes = bytes.replace("\r\n","\n");
-    // bstc doesn't return good exit status
-    QString progname;
-    QVariant pvar = process->property("Name");
-    if(pvar.canConvert(QVariant::String)) {
-        progname = pvar.toString();
-    }
-    if(progname.contains("bstc",Qt::CaseInsensitive)) {
-        if(QString(bytes).contains("Error",Qt::CaseInsensitive)) {
+    /* lines are assembled across reads and inserted as one block per read */
+    QStringList lines = loaderOutput.addBytes(bytes);
+
+    QString text;
+    for (int n = 0; n < lines.length(); n++) {
+        QString line = lines[n];
+        // the exit status alone can't be trusted
+        if(line.contains("error",Qt::CaseInsensitive)) {
             procResultError = true;
         }
-    }
 
-    if(QString(bytes).contains("error",Qt::CaseInsensitive)) {
-         compileStatus->insertPlainText(bytes);
-         procResultError = true;
-    }
-
-    QStringList lines = QString(bytes).split("\n",QString::SkipEmptyParts);
-    if(bytes.contains("bytes")) {
-        for (int n = 0; n < lines.length(); n++) {
-            QString line = lines[n];
-            if(line.length() > 0) {
-                if(line.indexOf("\r") > -1) {
-                    QStringList more = line.split("\r",QString::SkipEmptyParts);
-                    lines.removeAt(n);
-                    if(line.contains("Propeller Version",Qt::CaseInsensitive)) {
-                        compileStatus->insertPlainText(eol+line);
-                        progress->setValue(0);
-                    }
-                    for(int m = more.length()-1; m > -1; m--) {
-                        QString ms = more.at(m);
-                        if(ms.contains("bytes",Qt::CaseInsensitive))
-                            lines.insert(n,more.at(m));
-                        if(ms.contains("loading",Qt::CaseInsensitive))
-                            lines.insert(n,more.at(m));
-                    }
-                }
-            }
+        if(line.contains("Propeller Version",Qt::CaseInsensitive)) {
+            text += line+eol;
+            progress->setValue(0);
         }
-    }
-
-    for (int n = 0; n < lines.length(); n++) {
-        QString line = lines[n];
-        if(line.length() > 0) {
-            compileStatus->moveCursor(QTextCursor::End);
-            if(line.contains("Propeller Version",Qt::CaseInsensitive)) {
-                compileStatus->insertPlainText(line+eol);
-                progress->setValue(0);
-            }
-            else
-            if(line.contains("loading",Qt::CaseInsensitive)) {
-                progMax = 0;
-                progress->setValue(0);
-                compileStatus->insertPlainText(line+eol);
-            }
-            else
-            if(line.contains("writing",Qt::CaseInsensitive)) {
-                progMax = 0;
-                progress->setValue(0);
-            }
-            else
-            if(line.contains("Download OK",Qt::CaseInsensitive)) {
-                progress->setValue(100);
-                compileStatus->insertPlainText(line+eol);
-            }
-            else
-            if(line.contains("sent",Qt::CaseInsensitive)) {
-                compileStatus->moveCursor(QTextCursor::StartOfLine,QTextCursor::KeepAnchor);
-                compileStatus->insertPlainText(line+eol);
-            }
-            else
-            if(line.contains("remaining",Qt::CaseInsensitive)) {
+        else
+        if(line.contains("loading",Qt::CaseInsensitive)) {
+            progMax = 0;
+            progress->setValue(0);
+            text += line+eol;
+        }
+        else
+        if(line.contains("writing",Qt::CaseInsensitive)) {
+            progMax = 0;
+            progress->setValue(0);
+        }
+        else
+        if(line.contains("Download OK",Qt::CaseInsensitive)) {
+            progress->setValue(100);
+            text += line+eol;
+        }
+        else
+        if(line.contains("sent",Qt::CaseInsensitive) ||
+           line.contains("remaining",Qt::CaseInsensitive)) {
+            bool sent = line.contains("sent",Qt::CaseInsensitive);
+            if(!sent) {
                 if(progMax == 0) {
                     QString bs = line.mid(0,line.indexOf(" "));
                     progMax = bs.toInt();
@@ -4549,16 +4522,25 @@ void MainSpinWindow::procReadyRead()
                     progCount++;
                     progress->setValue(100*progCount/progMax);
                 }
-                compileStatus->moveCursor(QTextCursor::StartOfLine,QTextCursor::KeepAnchor);
-                compileStatus->insertPlainText(line);
             }
-            else {
-                compileStatus->insertPlainText(eol);
-                compileStatus->insertPlainText(line);
+            /* progress overwrites the current line, so flush first */
+            compileStatus->moveCursor(QTextCursor::End);
+            if(text.length() > 0) {
+                compileStatus->insertPlainText(text);
+                text.clear();
             }
+            compileStatus->moveCursor(QTextCursor::StartOfLine,QTextCursor::KeepAnchor);
+            compileStatus->insertPlainText(sent ? line+eol : line);
+        }
+        else {
+            text += eol+line;
         }
     }
 
+    if(text.length() > 0) {
+        compileStatus->moveCursor(QTextCursor::End);
+        compileStatus->insertPlainText(text);
+    }
 }
 
 /*
@@ -4575,48 +4557,27 @@ void MainSpinWindow::fileChanged()
 
     /* tab controls have been moved to the editor class */
 
-    QString curtext = ed->toPlainText();
-    if(curtext.length() == 0)
+    if(ed->document()->isEmpty())
         return;
     QString fileName = editorTabs->tabToolTip(index);
     if(fileName.length() == 0)
         return;
-    QFile file(fileName);
-    if(file.exists() == false) {
-        if(curtext.length() > 0) {
-            if(name.at(name.length()-1) != '*') {
-                name += tr(" *");
-                editorTabs->setTabText(index, name);
-            }
+    if(QFile::exists(fileName) == false) {
+        if(name.at(name.length()-1) != '*') {
+            name += tr(" *");
+            editorTabs->setTabText(index, name);
         }
         return;
     }
-    QString text;
-    int ret = 0;
 
+    /* The document is unmodified when its undo stack is back where the
+     * file was loaded or saved, so there's no need to re-read the file.
+     */
     QChar ch = name.at(name.length()-1);
-    if(file.open(QFile::ReadOnly))
-    {
-        QTextStream in(&file);
-        if(this->isFileUTF16(&file))
-            in.setCodec("UTF-16");
-        else
-            in.setCodec("UTF-8");
-
-        text = in.readAll();
-        file.close();
-
-        QString ctext = curtext;
-        QPlainTextEdit myed(this);
-        myed.setPlainText(text);
-        text = myed.toPlainText();
-
-        ret = ctext.compare(text);
-        if(ret == 0) {
-            if( ch == QChar('*'))
-                editorTabs->setTabText(index, this->shortFileName(fileName));
-            return;
-        }
+    if(ed->document()->isModified() == false) {
+        if( ch == QChar('*'))
+            editorTabs->setTabText(index, this->shortFileName(fileName));
+        return;
     }
     if( ch != QChar('*')) {
         name += tr(" *");
@@ -5151,6 +5112,7 @@ void MainSpinWindow::programBuildAllLibraries()
     QString workspace = propDialog->getCurrentWorkspace();
     QStringList files;
     if (workspace.endsWith("/") == false) workspace += "/";
+    LibraryIndex::shared()->open(workspace+"Learn/Simple Libraries");
     int rc = Directory::recursiveFindFileList(workspace+"Learn/Simple Libraries", "*.side", files);
     if (rc == 0) return;
 
@@ -5217,7 +5179,7 @@ void MainSpinWindow::programStopBuild()
         this->procMutex.lock();
         this->procDone = true;
         this->procMutex.unlock();
-        QApplication::processEvents();
+        ToolRunner::wakeAll();
         //process->kill(); // don't kill here. let the user process that is waiting kill it.
     }
 }
@@ -5924,6 +5886,9 @@ int  MainSpinWindow::runBuild(QString option)
     int rc = builder->runBuild(option, projectFile, aSideCompiler);
     statusDialog->stop();
 
+    diagnosticIndex = -1;
+    updateDiagnosticMarks();
+
     return rc;
 }
 
@@ -6155,6 +6120,7 @@ int  MainSpinWindow::runLoader(QString copts)
     process->setProperty("Name", QVariant(aSideLoader));
     process->setProperty("IsLoader", QVariant(true));
 
+    loaderOutput.startStream();
     connect(process, SIGNAL(readyReadStandardOutput()),this,SLOT(procReadyRead()));
     connect(process, SIGNAL(finished(int,QProcess::ExitStatus)),this,SLOT(procFinished(int,QProcess::ExitStatus)));
     connect(process, SIGNAL(error(QProcess::ProcessError)), this, SLOT(procError(QProcess::ProcessError)));
@@ -6178,6 +6144,7 @@ int  MainSpinWindow::runLoader(QString copts)
 
     portListener->close();
 
+    ToolRunner runner(process);
     process->start(aSideLoader,args);
     compileStatus->insertPlainText("\n");
 
@@ -6191,15 +6158,12 @@ int  MainSpinWindow::runLoader(QString copts)
         status->setText(status->text()+tr(" Loading ... "));
     }
 
-    while(procDone == false) {
-        QApplication::processEvents();
-        Sleeper::ms(20);
-    }
+    runner.wait(&procDone);
 
     int killed = 0;
     if(process->state() == QProcess::Running) {
         process->kill();
-        Sleeper::ms(33);
+        process->waitForFinished(1000);
         compileStatus->appendPlainText(tr("Loader killed by user."));
         status->setText(status->text() + tr(" Done."));
         killed = -1;
@@ -6749,6 +6713,13 @@ void MainSpinWindow::compileStatusClicked(void)
     compileStatus->setTextCursor(cur);
     line = cur.selectedText();
 
+    /* lines recorded as diagnostics while building need no parsing */
+    int index = builder->output().diagnosticAt(compileStatus->document(), cur.blockNumber());
+    if(index > -1 && showDiagnostic(index)) {
+        compileStatusClickEnable = true;
+        return;
+    }
+
     if(isCProject()) {
         cStatusClicked(line);
     }
@@ -6760,6 +6731,101 @@ void MainSpinWindow::compileStatusClicked(void)
     compileStatusClickEnable = true;
 }
 
+/*
+ * Full path of the file a diagnostic refers to.
+ */
+QString MainSpinWindow::diagnosticFile(const BuildOutput::Diagnostic &diag)
+{
+    QString file = diag.file;
+#ifdef SPIN
+    // spin compilers may leave off the extension
+    if(isSpinProject() && file.contains(SPIN_EXTENSION, Qt::CaseInsensitive) == false)
+        file += SPIN_EXTENSION;
+#endif
+    if(QFileInfo(file).isAbsolute() == false)
+        file = sourcePath(projectFile)+file;
+    return QDir::cleanPath(file);
+}
+
+/*
+ * Open the file of diagnostic index at its line and select its status line.
+ */
+bool MainSpinWindow::showDiagnostic(int index)
+{
+    const QList<BuildOutput::Diagnostic> &list = builder->output().diagnostics();
+    if(index < 0 || index >= list.count())
+        return false;
+    const BuildOutput::Diagnostic &diag = list[index];
+    QString file = diagnosticFile(diag);
+
+    /* open file in tab if not there already */
+    int n;
+    for(n = 0; n < editorTabs->count(); n++) {
+        if(QDir::cleanPath(editorTabs->tabToolTip(n)) == file)
+            break;
+    }
+    if(n < editorTabs->count()) {
+        editorTabs->setCurrentIndex(n);
+    }
+    else if(QFile::exists(file)) {
+        openFileName(file);
+    }
+    else {
+        return false;
+    }
+    diagnosticIndex = index;
+
+    if(diag.block > -1) {
+        bool enable = compileStatusClickEnable;
+        compileStatusClickEnable = false;
+        QTextCursor cur(compileStatus->document()->findBlockByNumber(diag.block));
+        cur.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+        compileStatus->setTextCursor(cur);
+        compileStatusClickEnable = enable;
+    }
+
+    Editor *editor = editors->at(editorTabs->currentIndex());
+    if(editor != NULL)
+    {
+        QTextCursor c(editor->document()->findBlockByNumber(diag.line > 0 ? diag.line-1 : 0));
+        editor->setTextCursor(c);
+        editor->setFocus();
+
+        // highlight error
+        emit highlightCurrentLine(QColor(255, 255, 0));
+    }
+    return true;
+}
+
+void MainSpinWindow::nextError()
+{
+    showDiagnostic(builder->output().nextDiagnostic(diagnosticIndex, true));
+}
+
+void MainSpinWindow::previousError()
+{
+    showDiagnostic(builder->output().nextDiagnostic(diagnosticIndex, false));
+}
+
+/*
+ * Mark the lines of open files that have errors or warnings.
+ */
+void MainSpinWindow::updateDiagnosticMarks()
+{
+    const QList<BuildOutput::Diagnostic> &list = builder->output().diagnostics();
+    QHash<QString, QHash<int,int> > marks;
+    foreach(BuildOutput::Diagnostic diag, list) {
+        if(diag.severity == BuildOutput::Note)
+            continue;
+        QHash<int,int> &lines = marks[diagnosticFile(diag)];
+        if(lines.value(diag.line, BuildOutput::Note) < diag.severity)
+            lines.insert(diag.line, diag.severity);
+    }
+    for(int n = 0; n < editors->count(); n++) {
+        editors->at(n)->setLineMarks(marks.value(QDir::cleanPath(editorTabs->tabToolTip(n))));
+    }
+}
+
 void MainSpinWindow::showCompileStatusError()
 {
     if(this->simpleViewType) {
@@ -6771,6 +6837,16 @@ void MainSpinWindow::showCompileStatusError()
     showStatusPane(true);
     btnShowStatusPane->setChecked(true);
 
+    // go to the first recorded error
+    const QList<BuildOutput::Diagnostic> &diags = builder->output().diagnostics();
+    for(int n = 0; n < diags.count(); n++) {
+        if(diags[n].severity == BuildOutput::Error) {
+            if(showDiagnostic(n))
+                return;
+            break;
+        }
+    }
+
     // find first error line
     QTextDocument *doc = compileStatus->document();
 
@@ -7440,7 +7516,10 @@ void MainSpinWindow::saveSpinProjectOptions()
         projectModel = new CBuildTree(projName, this);
 #ifdef SPIN
         /* for spin-side we always parse the program and stuff the file list */
+        QHash<QString, QByteArray> buffers = spinEditBuffers();
+        spinParser.setBuffers(buffers);
         list = spinParser.spinFileTree(fileName, propDialog->getSpinLibraryStr());
+        spinIndex.update(fileName, propDialog->getSpinLibraryStr(), buffers);
         for(int n = 0; n < list.count(); n ++) {
             QString arg = list[n];
             qDebug() << arg;
@@ -7578,6 +7657,24 @@ void MainSpinWindow::updateProjectTree(QString fileName)
         updateManagedProjectTree(fileName, projName);
 }
 
+/*
+ * Contents of modified Spin editors by file name, so the parsers
+ * see what is on screen rather than what was last saved.
+ */
+QHash<QString, QByteArray> MainSpinWindow::spinEditBuffers()
+{
+    QHash<QString, QByteArray> buffers;
+    for(int n = 0; n < editors->count(); n++) {
+        QString fileName = editorTabs->tabToolTip(n);
+        if(!fileName.endsWith(SPIN_EXTENSION, Qt::CaseInsensitive))
+            continue;
+        Editor *ed = editors->at(n);
+        if(ed->document()->isModified())
+            buffers.insert(fileName, ed->toPlainText().toUtf8());
+    }
+    return buffers;
+}
+
 void MainSpinWindow::updateSpinProjectTree(QString fileName, QString projName)
 {
 #ifdef SPIN
@@ -7585,7 +7682,10 @@ void MainSpinWindow::updateSpinProjectTree(QString fileName, QString projName)
 
     /* for spin-side we always parse the program and stuff the file list */
 
+    QHash<QString, QByteArray> buffers = spinEditBuffers();
+    spinParser.setBuffers(buffers);
     QStringList flist = spinParser.spinFileTree(fileName, propDialog->getSpinLibraryStr());
+    spinIndex.update(fileName, propDialog->getSpinLibraryStr(), buffers);
     for(int n = 0; n < flist.count(); n ++) {
         QString s = flist[n];
         qDebug() << s;
@@ -7846,10 +7946,7 @@ void MainSpinWindow::findChip()
 
     compileStatus->setPlainText("Identifying Propellers ...\n");
 
-    if(rtsReset())
-        propId.setRtsReset();
-    else
-        propId.setDtrReset();
+    propScan.setRtsReset(rtsReset());
 
     int indx = cbPort->currentIndex();
     this->enumeratePorts();
@@ -7857,14 +7954,18 @@ void MainSpinWindow::findChip()
     if(indx < size)
         cbPort->setCurrentIndex(indx);
 
-    for (int n = 1; n < size; n++) {
-        QString mp;
-        mp = cbPort->itemText(n);
-        int rc = propId.isDevice(mp);
-        if(rc < 0) {
+    QStringList ports;
+    for (int n = 1; n < size; n++)
+        ports.append(cbPort->itemText(n));
+
+    // an explicit identify always probes every port
+    QList<PropellerScan::Result> found = propScan.scan(ports, false, false);
+    foreach(PropellerScan::Result r, found) {
+        QString mp = r.port;
+        if(r.status < 0) {
             compileStatus->appendPlainText("  Port "+mp+" is busy.");
-        } else if(rc > 0) {
-            compileStatus->appendPlainText("  Propeller found on "+mp+".");
+        } else if(r.status > 0) {
+            compileStatus->appendPlainText("  Propeller version "+QString::number(r.version)+" found on "+mp+".");
         } else {
             compileStatus->appendPlainText("  Propeller not found on "+mp+".");
         }
@@ -7875,23 +7976,19 @@ QString MainSpinWindow::serialPort()
 {
     int portIndex = cbPort->currentIndex();
     if(cbPort->currentText().compare(AUTO_PORT) == 0) {
-        if(rtsReset())
-            propId.setRtsReset();
-        else
-            propId.setDtrReset();
+        propScan.setRtsReset(rtsReset());
 
         //compileStatus->setPlainText("Finding first available propeller ... ");
         int size = cbPort->count();
 
-        for (int n = 1; n < size; n++) {
-            QString mp;
-            mp = cbPort->itemText(n);
-            int rc = propId.isDevice(mp);
-            if(rc > 0) {
-                //compileStatus->appendPlainText("Propeller found on "+mp+".");
-                portIndex = n;
-                break;
-            }
+        QStringList ports;
+        for (int n = 1; n < size; n++)
+            ports.append(cbPort->itemText(n));
+
+        QList<PropellerScan::Result> found = propScan.scan(ports, true);
+        if(found.count() > 0) {
+            //compileStatus->appendPlainText("Propeller found on "+found.at(0).port+".");
+            portIndex = ports.indexOf(found.at(0).port)+1;
         }
     }
     return(cbPort->itemText(portIndex));
@@ -8034,10 +8131,10 @@ QList<WxPortInfo> MainSpinWindow::getWxPorts(void)
 
     qDebug() << aSideLoader << args;
 
+    ToolRunner runner(wxProcess);
     wxProcess->start(aSideLoader, args);
 
-    while(procDone == false)
-        QApplication::processEvents();
+    runner.wait(&procDone);
 
     statusDialog->stop();
 
@@ -8068,10 +8165,10 @@ QList<WxPortInfo> MainSpinWindow::getWxPorts(void)
 
     qDebug() << aSideLoader << args;
 
+    ToolRunner runner(wxProcess);
     wxProcess->start(aSideLoader, args);
 
-    while(procDone == false)
-        QApplication::processEvents();
+    runner.wait(&procDone);
 
     statusDialog->stop();
 
@@ -8472,7 +8569,7 @@ void MainSpinWindow::initBoardTypes()
 
 int MainSpinWindow::setupEditor()
 {
-    Editor *editor = new Editor(gdb, &spinParser, this);
+    Editor *editor = new Editor(gdb, &spinIndex, this);
     editor->setTabStopWidth(propDialog->getTabSpaces()*10);
 
     /* font is user's preference */
@@ -8501,6 +8598,7 @@ void MainSpinWindow::setEditorTab(int num, QString shortName, QString fileName,
     editorTabs->setTabText(num,shortName);
     editorTabs->setTabToolTip(num,fileName);
     editorTabs->setCurrentIndex(num);
+    updateDiagnosticMarks();
     currentTabChanged();
     qDebug() << "setEditorTab" << fileName << num << "Total Tabs" << editorTabs->count() << "Total Editors" << editors->count();
 }
@@ -8634,6 +8732,8 @@ void MainSpinWindow::setupFileMenu()
     }
 
     toolsMenu->addAction(QIcon(":/images/NextTab2.png"), tr("Next Tab"), this, SLOT(changeTab(bool)),QKeySequence::NextChild);
+    toolsMenu->addAction(tr("Next Error"), this, SLOT(nextError()), Qt::CTRL+Qt::Key_E);
+    toolsMenu->addAction(tr("Previous Error"), this, SLOT(previousError()), Qt::CTRL+Qt::ShiftModifier+Qt::Key_E);
 
     toolsMenu->addSeparator();
     toolsMenu->addAction(QIcon(":/images/FontTT.png"), tr("Font"), this, SLOT(fontDialog()));
@@ -58,7 +58,8 @@
 #include "buildc.h"
 #include "buildspin.h"
 #include "spinparser.h"
-#include "PropellerID.h"
+#include "spinindex.h"
+#include "PropellerScan.h"
 #include "PortConnectionMonitor.h"
 #include "zipper.h"
 #include "StatusDialog.h"
@@ -146,6 +147,8 @@ public slots:
     void saveTab(int index = 0, bool ask = true);
     void editorTabMenu(QPoint);
     void changeTab(bool trig);
+    void nextError();
+    void previousError();
     QStringList projectList(QString projFile);
     void currentTabChanged();
     void clearTabHighlight();
@@ -341,6 +344,7 @@ private:
     void updateProjectTree(QString fileName);
     void updateManagedProjectTree(QString fileName, QString projName);
     void updateSpinProjectTree(QString fileName, QString projName);
+    QHash<QString, QByteArray> spinEditBuffers();
 
     void setEditorTab(int num, QString shortName, QString fileName, QString text);
     QString shortFileName(QString fileName);
@@ -348,6 +352,9 @@ private:
 
     void cStatusClicked(QString line);
     void spinStatusClicked(QString line);
+    QString diagnosticFile(const BuildOutput::Diagnostic &diag);
+    bool showDiagnostic(int index);
+    void updateDiagnosticMarks();
 
     void resetVerticalSplitSize();
     void resetRightSplitSize();
@@ -416,6 +423,7 @@ private:
 
     QPlainTextEdit  *compileStatus;
     bool            compileStatusClickEnable;
+    int             diagnosticIndex;
 
     QString         projectFile;
     CBuildTree      *projectModel;
@@ -458,6 +466,7 @@ private:
     bool            procDone;
     bool            procResultError;
     QMutex          procMutex;
+    BuildOutput     loaderOutput;
 
     Hardware        *hardwareDialog;
     QLabel          *status;
@@ -498,10 +507,11 @@ private:
     BuildC          *buildC;
     BuildSpin       *buildSpin;
     SpinParser      spinParser;
+    SpinIndex       spinIndex;
 
     Blinker         *blinker;
 
-    PropellerID     propId;
+    PropellerScan   propScan;
 
     PortConnectionMonitor *portConnectionMonitor;
 
@@ -20,6 +20,7 @@
 #include "properties.h"
 #include "directory.h"
 #include "zipper.h"
+#include "buildjobs.h"
 
 #include <QDir>
 #include <QFile>
@@ -393,6 +394,19 @@ void Properties::stopStatusDialog()
     statDialog->stop(4);
 }
 
+void Properties::copyProgress(const QString &fileName, int copied, int total)
+{
+    statDialog->setMessage(tr("Copying: ")+QString("%1/%2 ").arg(copied).arg(total)+
+                           fileName.mid(fileName.lastIndexOf("/")+1));
+}
+
+void Properties::copyFailed(const QStringList &fileNames)
+{
+    QMessageBox::warning(this, tr("SimpleIDE Workspace Copy Error"),
+        tr("These files could not be copied:")+"\n"+QStringList(fileNames.mid(0,10)).join("\n")+
+        (fileNames.count() > 10 ? "\n..." : ""));
+}
+
 void Properties::saveUpdateFile(QString name, QString timestamp)
 {
     // create a timestamp file
@@ -417,7 +431,7 @@ bool Properties::createPackageWorkspace(QString pkwrk, QString &mywrk, QString u
 
         mywrk = wrk;
         mylib = wrk+LEARNLIB;
-        Directory::recursiveCopyDir(pkwrk, mywrk);
+        Directory::recursiveCopyDir(pkwrk, mywrk, "", this);
         saveUpdateFile(mywrk+updateFile, timestamp);
 
         stopStatusDialog();
@@ -482,7 +496,7 @@ bool Properties::updatePackageWorkspace(QString pkwrk, QString mywrk, QString up
         int rc = 0;
         if(wrkd.exists(mywrk) == true) {
 
-            rc |= zip.zipit(mywrk, zipback) ? 0 : 1;
+            rc |= zip.zipit(mywrk, zipback, statDialog) ? 0 : 1;
             if(rc) {
                 QMessageBox::information(this,tr("SimpleIDE Workspace Backup Error"),
                     tr("Could not backup SimpleIDE workspace to:")+"\n"+
@@ -491,8 +505,8 @@ bool Properties::updatePackageWorkspace(QString pkwrk, QString mywrk, QString up
         }
         if(!rc) {
 
-            Directory::recursiveCopyDir(mywrk, temp);
-            Directory::recursiveCopyDir(pkwrk, mywrk);
+            Directory::recursiveCopyDir(mywrk, temp, "", this);
+            Directory::recursiveCopyDir(pkwrk, mywrk, "", this);
 
             saveUpdateFile(mywrk+updateFile, timestamp);
 
@@ -778,7 +792,7 @@ bool Properties::updateLearnWorkspace()
             }
 
             if(wrkd.exists(mywrk) == true) {
-                rc |= zip.zipit(ws, zipback) ? 0 : 1;
+                rc |= zip.zipit(ws, zipback, statDialog) ? 0 : 1;
                 if(rc) {
                     stopStatusDialog();
                     QMessageBox::information(this,tr("Workspace Backup Error"),
@@ -1044,6 +1058,20 @@ void Properties::setupGeneral()
         loadDelay.setText(s);
     }
 
+    QLabel *lBuildJobs = new QLabel(tr("Parallel Build Jobs"),tbox);
+    lBuildJobs->setToolTip(tr("Number of C files to compile at the same time."));
+    tlayout->addWidget(lBuildJobs,row,0);
+    buildJobs.setMaximumWidth(40);
+    buildJobs.setText(QString("%1").arg(BuildJobs::defaultJobs()));
+    buildJobs.setAlignment(Qt::AlignHCenter);
+    tlayout->addWidget(&buildJobs,row++,1);
+
+    var = settings.value(buildJobsKey);
+    if(var.canConvert(QVariant::Int)) {
+        QString s = var.toString();
+        buildJobs.setText(s);
+    }
+
     QLabel *lreset = new QLabel(tr("Reset Signal"),tbox);
     tlayout->addWidget(lreset,row,0);
     resetType.addItem("DTR");
@@ -1764,6 +1792,7 @@ void Properties::accept()
     //settings.setValue(autoLibIncludeKey,autoLibCheck.isChecked());
     settings.setValue(tabSpacesKey,tabSpaces.text());
     settings.setValue(loadDelayKey,loadDelay.text());
+    settings.setValue(buildJobsKey,buildJobs.text());
     settings.setValue(resetTypeKey,resetType.currentIndex());
 
     settings.setValue(hlNumStyleKey,hlNumStyle.isChecked());
@@ -1810,6 +1839,7 @@ void Properties::reject()
     //autoLibCheck.setChecked(useAutoLib);
     tabSpaces.setText(tabSpacesStr);
     loadDelay.setText(loadDelayStr);
+    buildJobs.setText(buildJobsStr);
     resetType.setCurrentIndex(resetTypeEnum);
     hlNumStyle.setChecked(hlNumStyleBool);
     hlNumWeight.setChecked(hlNumWeightBool);
@@ -1849,6 +1879,7 @@ void Properties::showProperties()
     useAutoLib = autoLibCheck.isChecked();
     tabSpacesStr = tabSpaces.text();
     loadDelayStr = loadDelay.text();
+    buildJobsStr = buildJobs.text();
     resetTypeEnum = (Reset)resetType.currentIndex();
     hlNumStyleBool = hlNumStyle.isChecked();
     hlNumWeightBool = hlNumWeight.isChecked();
@@ -1887,6 +1918,14 @@ int Properties::getLoadDelay()
     return loadDelay.text().toInt();
 }
 
+int Properties::getBuildJobs()
+{
+    int jobs = buildJobs.text().toInt();
+    if(jobs < 1)
+        jobs = BuildJobs::defaultJobs();
+    return jobs;
+}
+
 Properties::Reset Properties::getResetType()
 {
     return (Reset) resetType.currentIndex();
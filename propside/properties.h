@@ -32,6 +32,7 @@
 #define PROPERTIES_H
 
 #include "propertycolor.h"
+#include "directory.h"
 #include "StatusDialog.h"
 #include "workspacedialog.h"
 
@@ -75,6 +76,7 @@
 #define recentProjectsKey   "SimpleIDE_recentProjectsList"
 #define tabSpacesKey        "SimpleIDE_TabSpacesCount"
 #define loadDelayKey        "SimpleIDE_LoadDelay_us"
+#define buildJobsKey        "SimpleIDE_BuildJobs"
 #define resetTypeKey        "SimpleIDE_ResetType"
 #define spinCompilerKey     "SimpleIDE_SpinCompiler"
 #define altTerminalKey      "SimpleIDE_AltTerminal"
@@ -102,7 +104,7 @@
 #define hlBlockComColorKey  "SimpleIDE_HighlightBlockCommentTypeColor"
 #define HintKeyPrefix       "SimpleIDE_Hint_"
 
-class Properties : public QDialog
+class Properties : public QDialog, public Directory::Progress
 {
     Q_OBJECT
 public:
@@ -112,6 +114,7 @@ public:
 
     int getTabSpaces();
     int getLoadDelay();
+    int getBuildJobs();
     int setComboIndexByValue(QComboBox *combo, QString value);
 
     Qt::GlobalColor getQtColor(int index);
@@ -124,6 +127,8 @@ public:
 
     void showStatusDialog(QString title, const QString text);
     void stopStatusDialog();
+    void copyProgress(const QString &fileName, int copied, int total);
+    void copyFailed(const QStringList &fileNames);
     void saveUpdateFile(QString name, QString timestamp);
     bool workspaceSane(QString pkwrk, QString mywrk);
     bool replaceLearnWorkspace();
@@ -194,6 +199,7 @@ private:
     
     QString     tabSpacesStr;
     QString     loadDelayStr;
+    QString     buildJobsStr;
     Reset       resetTypeEnum;
 
     bool        useAutoLib;
@@ -232,6 +238,7 @@ private:
 
     QLineEdit   tabSpaces;
     QLineEdit   loadDelay;
+    QLineEdit   buildJobs;
     QComboBox   resetType;
     QCheckBox   keepZipFolder;
     QCheckBox   autoLibCheck;
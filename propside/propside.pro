@@ -62,6 +62,7 @@ DEFINES += ENABLE_FILETO_SDCARD
 SOURCES += mainspin.cpp \
     PortConnectionMonitor.cpp \
     PropellerID.cpp \
+    PropellerScan.cpp \
     editor.cpp \
     ctags.cpp \
     mainspinwindow.cpp \
@@ -74,10 +75,13 @@ SOURCES += mainspin.cpp \
     properties.cpp \
     newproject.cpp \
     PortListener.cpp \
+    bytequeue.cpp \
+    capturefile.cpp \
     highlighter.cpp \
     hardware.cpp \
     help.cpp \
     console.cpp \
+    termscreen.cpp \
     asideconfig.cpp \
     asideboard.cpp \
     projectoptions.cpp \
@@ -89,8 +93,14 @@ SOURCES += mainspin.cpp \
     buildc.cpp \
     buildspin.cpp \
     build.cpp \
+    buildjobs.cpp \
+    buildcache.cpp \
+    buildoutput.cpp \
+    libraryindex.cpp \
+    toolrunner.cpp \
     spinhighlighter.cpp \
     spinparser.cpp \
+    spinindex.cpp \
     gdb.cpp \
     highlightc.cpp \
     hintdialog.cpp \
@@ -107,17 +117,21 @@ SOURCES += mainspin.cpp \
 HEADERS += mainspinwindow.h \
     PortConnectionMonitor.h \
     PropellerID.h \
+    PropellerScan.h \
     editor.h \
     ctags.h \
     highlighter.h \
     treemodel.h \
     treeitem.h \
     PortListener.h \
+    bytequeue.h \
+    capturefile.h \
     terminal.h \
     termprefs.h \
     properties.h \
     newproject.h \
     console.h \
+    termscreen.h \
     hardware.h \
     help.h \
     asideboard.h \
@@ -134,8 +148,14 @@ HEADERS += mainspinwindow.h \
     buildc.h \
     buildspin.h \
     build.h \
+    buildjobs.h \
+    buildcache.h \
+    buildoutput.h \
+    libraryindex.h \
+    toolrunner.h \
     spinhighlighter.h \
     spinparser.h \
+    spinindex.h \
     gdb.h \
     highlightc.h \
     propertycolor.h \
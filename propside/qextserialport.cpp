@@ -527,9 +527,40 @@ void QextSerialPort::close()
         QIODevice::close(); // mark ourselves as closed
         d->close_sys();
         d->readBuffer.clear();
+        d->wakeUp_sys();
     }
 }
 
+/*! \reimp
+    Blocks until there is data to read, the port is closed, wakeUp() is called,
+    or msecs milliseconds have passed. A negative msecs waits without a time limit.
+    Returns true if data can be read.
+
+    The port lock is not held while waiting, so another thread may write to
+    the port or close it meanwhile.
+*/
+bool QextSerialPort::waitForReadyRead(int msecs)
+{
+    Q_D(QextSerialPort);
+    {
+        QReadLocker locker(&d->lock);
+        if (!isOpen())
+            return false;
+        if (!d->readBuffer.isEmpty() || QIODevice::bytesAvailable() > 0)
+            return true;
+    }
+    return d->waitForReadyRead_sys(msecs);
+}
+
+/*!
+    Makes a thread blocked in waitForReadyRead() return early.
+*/
+void QextSerialPort::wakeUp()
+{
+    Q_D(QextSerialPort);
+    d->wakeUp_sys();
+}
+
 /*!
     Flushes all pending I/O to the serial port.  This function has no effect if the serial port
     associated with the class is not currently open.
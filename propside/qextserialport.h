@@ -199,6 +199,8 @@ public:
     void flush();
     qint64 bytesAvailable() const;
     QByteArray readAll();
+    bool waitForReadyRead(int msecs);
+    void wakeUp();
 
     ulong lastError() const;
 
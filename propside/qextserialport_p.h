@@ -188,6 +188,7 @@ public:
     // platform specific members
 #ifdef Q_OS_UNIX
     int fd;
+    int wakePipe[2];
     QSocketNotifier *readNotifier;
     struct termios Posix_CommConfig;
     struct termios old_termios;
@@ -205,6 +206,7 @@ public:
     QList<OVERLAPPED*> pendingWrites;
     QReadWriteLock* bytesToWriteLock;
     qint64 _bytesToWrite;
+    HANDLE wakeEvent;
 #endif
 
     /*fill PortSettings*/
@@ -230,6 +232,8 @@ public:
     bool flush_sys();
     ulong lineStatus_sys();
     qint64 bytesAvailable_sys() const;
+    bool waitForReadyRead_sys(int msecs);
+    void wakeUp_sys();
 
 #ifdef Q_OS_WIN
     void _q_onWinEvent(HANDLE h);
@@ -39,6 +39,7 @@
 #include <sys/ioctl.h>
 #include <sys/select.h>
 #include <QtCore/QMutexLocker>
+#include <QtCore/QReadLocker>
 #include <QtCore/QDebug>
 #include <QtCore/QSocketNotifier>
 
@@ -46,6 +47,14 @@ void QextSerialPortPrivate::platformSpecificInit()
 {
     fd = 0;
     readNotifier = 0;
+    if (::pipe(wakePipe) == 0) {
+        ::fcntl(wakePipe[0], F_SETFL, O_NONBLOCK);
+        ::fcntl(wakePipe[1], F_SETFL, O_NONBLOCK);
+    }
+    else {
+        wakePipe[0] = -1;
+        wakePipe[1] = -1;
+    }
 }
 
 /*!
@@ -53,6 +62,10 @@ void QextSerialPortPrivate::platformSpecificInit()
 */
 void QextSerialPortPrivate::platformSpecificDestruct()
 {
+    if (wakePipe[0] != -1)
+        ::close(wakePipe[0]);
+    if (wakePipe[1] != -1)
+        ::close(wakePipe[1]);
 }
 
 bool QextSerialPortPrivate::open_sys(QIODevice::OpenMode mode)
@@ -137,6 +150,59 @@ qint64 QextSerialPortPrivate::bytesAvailable_sys() const
     return bytesQueued;
 }
 
+/*!
+    \internal
+    Waits in select() on the port and the wakeup pipe. select() is used rather
+    than poll() because poll() doesn't work on tty devices on older Mac OS X.
+*/
+bool QextSerialPortPrivate::waitForReadyRead_sys(int msecs)
+{
+    int portfd;
+    {
+        QReadLocker locker(&lock);
+        portfd = fd;
+    }
+    if (portfd < 0)
+        return false;
+
+    int rc;
+    fd_set fds;
+    do {
+        FD_ZERO(&fds);
+        FD_SET(portfd, &fds);
+        int maxfd = portfd;
+        if (wakePipe[0] != -1) {
+            FD_SET(wakePipe[0], &fds);
+            if (wakePipe[0] > maxfd)
+                maxfd = wakePipe[0];
+        }
+        struct timeval tv;
+        tv.tv_sec = msecs / 1000;
+        tv.tv_usec = (msecs % 1000) * 1000;
+        rc = ::select(maxfd+1, &fds, NULL, NULL, msecs < 0 ? NULL : &tv);
+    } while (rc < 0 && errno == EINTR);
+
+    if (rc <= 0)
+        return false;
+    if (wakePipe[0] != -1 && FD_ISSET(wakePipe[0], &fds)) {
+        char drain[16];
+        while (::read(wakePipe[0], drain, sizeof(drain)) > 0)
+            ;
+        return false;
+    }
+    return FD_ISSET(portfd, &fds) != 0;
+}
+
+void QextSerialPortPrivate::wakeUp_sys()
+{
+    if (wakePipe[1] != -1) {
+        char c = 0;
+        if (::write(wakePipe[1], &c, 1) < 0) {
+            // pipe is full, a wakeup is already pending
+        }
+    }
+}
+
 /*!
     Translates a system-specific error code to a QextSerialPort error code.  Used internally.
 */
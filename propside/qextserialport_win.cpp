@@ -33,10 +33,12 @@
 #include "qextserialport_p.h"
 #include <QtCore/QThread>
 #include <QtCore/QReadWriteLock>
+#include <QtCore/QReadLocker>
 #include <QtCore/QMutexLocker>
 #include <QtCore/QDebug>
 #include <QtCore/QRegExp>
 #include <QtCore/QMetaType>
+#include <QtCore/QTime>
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
 #  include <QtCore/QWinEventNotifier>
 #  define WinEventNotifier QWinEventNotifier
@@ -55,10 +57,12 @@ void QextSerialPortPrivate::platformSpecificInit()
     winEventNotifier = 0;
     bytesToWriteLock = new QReadWriteLock;
     _bytesToWrite = 0;
+    wakeEvent = CreateEvent(NULL, false, false, NULL);
 }
 
 void QextSerialPortPrivate::platformSpecificDestruct() {
     CloseHandle(overlap.hEvent);
+    CloseHandle(wakeEvent);
     delete bytesToWriteLock;
 }
 
@@ -159,6 +163,37 @@ qint64 QextSerialPortPrivate::bytesAvailable_sys() const
     return (qint64)-1;
 }
 
+/*!
+    \internal
+    A polling mode handle is not overlapped, so there is nothing to wait on for
+    received characters. Check the receive queue between short waits on the
+    wakeup event instead; wakeUp() and close() still end the wait at once.
+*/
+bool QextSerialPortPrivate::waitForReadyRead_sys(int msecs)
+{
+    const DWORD step = 5;
+    QTime timer;
+    timer.start();
+    forever {
+        {
+            QReadLocker locker(&lock);
+            if (Win_Handle == INVALID_HANDLE_VALUE)
+                return false;
+            if (bytesAvailable_sys() > 0)
+                return true;
+        }
+        if (msecs >= 0 && timer.elapsed() >= msecs)
+            return false;
+        if (WaitForSingleObject(wakeEvent, step) == WAIT_OBJECT_0)
+            return false;
+    }
+}
+
+void QextSerialPortPrivate::wakeUp_sys()
+{
+    SetEvent(wakeEvent);
+}
+
 /*
     Translates a system-specific error code to a QextSerialPort error code.  Used internally.
 */
@@ -0,0 +1,149 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "spinindex.h"
+
+SpinIndex::SpinIndex(QObject *parent) : QThread(parent)
+{
+    abort = false;
+}
+
+SpinIndex::~SpinIndex()
+{
+    mutex.lock();
+    abort = true;
+    wake.wakeOne();
+    mutex.unlock();
+    wait();
+}
+
+void SpinIndex::update(QString file, QString libpath, QHash<QString, QByteArray> buffers)
+{
+    QMutexLocker locker(&mutex);
+    pendingFile = file;
+    pendingLib = libpath;
+    pendingBuffers = buffers;
+    if(!isRunning())
+        start(QThread::LowPriority);
+    wake.wakeOne();
+}
+
+/*
+ * Only the latest request matters. The parser lives on this thread
+ * and keeps its file cache, so saving one file reparses just that file.
+ */
+void SpinIndex::run()
+{
+    SpinParser parser;
+
+    QMutexLocker locker(&mutex);
+    while(!abort) {
+        if(pendingFile.isEmpty()) {
+            wake.wait(&mutex);
+            continue;
+        }
+        QString file = pendingFile;
+        QString libpath = pendingLib;
+        QHash<QString, QByteArray> buffers = pendingBuffers;
+        pendingFile.clear();
+        pendingBuffers.clear();
+        locker.unlock();
+
+        QHash<QString, EntryList> objs;
+        QHash<QString, EntryList> fileSyms;
+        parser.setBuffers(buffers);
+        parser.parseTree(file, libpath);
+        buildIndex(parser.symbolTable(), objs, fileSyms);
+
+        locker.relock();
+        objects = objs;
+        files = fileSyms;
+    }
+}
+
+/*
+ * Table keys are name paths like root/obj/subobj:name and values are
+ * symbol\tfile\tdeclaration\ttype tags.
+ */
+void SpinIndex::buildIndex(const QMap<QString, QString> &table,
+                           QHash<QString, EntryList> &objs, QHash<QString, EntryList> &fileSyms)
+{
+    QMap<QString, QString>::const_iterator it;
+    for(it = table.constBegin(); it != table.constEnd(); ++it) {
+        QStringList tabs = it.value().split("\t");
+        if(tabs.count() < 4)
+            continue;
+
+        Entry entry;
+        entry.key = tabs.at(0).toLower();
+        entry.type = tabs.at(3);
+        entry.item = entry.type+"\t"+tabs.at(2);
+        if(entry.type.contains("c",Qt::CaseInsensitive))
+            entry.constItem = entry.item;
+        else if(entry.type.contains("e",Qt::CaseInsensitive))
+            entry.constItem = entry.type+"\t"+tabs.at(0);
+
+        QString path = it.key();
+        path = path.left(path.indexOf(":"));
+        objs[path.mid(path.lastIndexOf("/")+1).toLower()].append(entry);
+        fileSyms[QFileInfo(tabs.at(1)).fileName().toLower()].append(entry);
+    }
+
+    QHash<QString, EntryList>::iterator list;
+    for(list = objs.begin(); list != objs.end(); ++list)
+        qSort(list->begin(), list->end());
+    for(list = fileSyms.begin(); list != fileSyms.end(); ++list)
+        qSort(list->begin(), list->end());
+}
+
+SpinIndex::EntryList SpinIndex::entries(QString file, QString objname)
+{
+    QMutexLocker locker(&mutex);
+    if(objname.length() > 0)
+        return objects.value(objname.toLower());
+    /* editors pass the tab name, which may be marked modified */
+    if(file.endsWith(" *"))
+        file.chop(2);
+    return files.value(QFileInfo(file).fileName().toLower());
+}
+
+QStringList SpinIndex::matching(const EntryList &list, QString prefix, bool constant)
+{
+    QStringList result;
+    Entry find;
+    find.key = prefix.toLower();
+    EntryList::const_iterator it = qLowerBound(list.constBegin(), list.constEnd(), find);
+    for(; it != list.constEnd() && it->key.startsWith(find.key); ++it) {
+        if(!constant)
+            result.append(it->item);
+        else if(it->constItem.length() > 0)
+            result.append(it->constItem);
+    }
+    return result;
+}
+
+QStringList SpinIndex::symbols(QString file, QString objname, QString prefix)
+{
+    return matching(entries(file, objname), prefix, false);
+}
+
+QStringList SpinIndex::constants(QString file, QString objname, QString prefix)
+{
+    return matching(entries(file, objname), prefix, true);
+}
@@ -0,0 +1,80 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPININDEX_H
+#define SPININDEX_H
+
+#include <QtCore>
+
+#include "spinparser.h"
+
+/*
+ * Keeps a symbol index of the current Spin project for autocomplete.
+ * Parsing is done on this thread so the editor only does lookups.
+ */
+class SpinIndex : public QThread
+{
+    Q_OBJECT
+public:
+    explicit SpinIndex(QObject *parent = 0);
+    virtual ~SpinIndex();
+
+    /* queue the project with top file for indexing. see SpinParser::setBuffers */
+    void update(QString file, QString libpath,
+                QHash<QString, QByteArray> buffers = QHash<QString, QByteArray>());
+
+    /*
+     * Autocomplete lookups. If objname is empty, symbols declared in
+     * file are returned. Items are "type\tdeclaration" like tagItem.
+     */
+    QStringList symbols(QString file, QString objname, QString prefix = "");
+    QStringList constants(QString file, QString objname, QString prefix = "");
+
+protected:
+    void run();
+
+private:
+    typedef struct Entry {
+        QString key;        /* lower case name for prefix search */
+        QString type;
+        QString item;       /* type and declaration */
+        QString constItem;  /* what constants() shows, if anything */
+        bool operator<(const struct Entry &other) const { return key < other.key; }
+    } Entry;
+
+    typedef QVector<Entry> EntryList;
+
+    void buildIndex(const QMap<QString, QString> &table,
+                    QHash<QString, EntryList> &objs, QHash<QString, EntryList> &fileSyms);
+    EntryList entries(QString file, QString objname);
+    QStringList matching(const EntryList &list, QString prefix, bool constant);
+
+    QMutex          mutex;
+    QWaitCondition  wake;
+    bool            abort;
+    QString         pendingFile;
+    QString         pendingLib;
+    QHash<QString, QByteArray> pendingBuffers;
+
+    /* entries by object instance name and by declaring file short name */
+    QHash<QString, EntryList> objects;
+    QHash<QString, EntryList> files;
+};
+
+#endif // SPININDEX_H
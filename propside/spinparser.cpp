@@ -24,6 +24,8 @@
 
 SpinParser::SpinParser()
 {
+    parseList = NULL;
+
     setKind(&SpinKinds[SpinParser::K_NONE],     false,'n', "none", "none"); // place-holder only
     setKind(&SpinKinds[SpinParser::K_CONST],    true, 'c', "constant", "constants");
     setKind(&SpinKinds[SpinParser::K_PUB],      true, 'f', "public", "methods");
@@ -80,10 +82,7 @@ QStringList SpinParser::spinFileTree(QString file, QString libpath)
     QString subnode;
     QString subfile;
 
-    libraryPath = libpath;
-    clearDB();
-
-    this->findSpinTags(file, "root");
+    parseTree(file, libpath);
 
     spinFiles.append(file.mid(file.lastIndexOf("/")+1));
     QStringList keys = db.keys();
@@ -110,6 +109,19 @@ QStringList SpinParser::spinFileTree(QString file, QString libpath)
     return spinFiles;
 }
 
+void SpinParser::parseTree(QString file, QString libpath)
+{
+    libraryPath = libpath;
+    clearDB();
+
+    this->findSpinTags(file, "root");
+}
+
+QMap<QString, QString> SpinParser::symbolTable()
+{
+    return db;
+}
+
 void SpinParser::makeTags(QString file)
 {
     QStringList keys = db.keys();
@@ -309,233 +321,158 @@ QStringList SpinParser::spinObjects(QString file, QString objname)
 
 /*
  *   FUNCTION DEFINITIONS
+ *
+ * The match functions work on the bytes of one line with comments
+ * removed and white space trimmed. Only symbols found become strings.
  */
 
-/* Match the name of a tag (function, variable, type, ...) starting at pos. */
-char const *SpinParser::extract_name (char const *pos, QString &name)
+static bool isWordChar(char c)
 {
-    while (isspace (*pos))
-        pos++;
-    name.clear();
-    for (; *pos && !isspace (*pos) && *pos != '(' && *pos != ','; pos++)
-        name.append(*pos);
-    return pos;
+    return isalnum((unsigned char) c) || c == '_';
 }
 
-int SpinParser::tokentype(QString tmp)
+/* If s starts with the word kw (case insensitive), return the length of kw. */
+static int keywordLength(const QByteArray &s, const char *kw)
 {
-    int rc = K_NONE;
-    int i;
-    /* find out token type for parser states */
-    if(tmp.indexOf(' ') > 0) {
-        tmp = tmp.mid(0,tmp.indexOf(' '));
-    }
-    for (i = 0; spin_keywords[i].token != NULL; i++)
-    {
-        if (tmp.compare(spin_keywords[i].token,Qt::CaseInsensitive) == 0) {
-            rc = spin_keywords[i].kind;
-            break;
-        }
-    }
-    return rc;
+    int len = qstrlen(kw);
+    if(s.length() < len || qstrnicmp(s.constData(), kw, len) != 0)
+        return 0;
+    if(s.length() > len && isWordChar(s.at(len)))
+        return 0;
+    return len;
 }
 
-/* Match a keyword starting at p (case insensitive). */
-int SpinParser::match_keyword (const char *p, KeyWord const *kw, QString &tag)
+/* Remove a leading keyword like con or dat. */
+static QByteArray skipKeyword(const QByteArray &s, const char *kw)
 {
-    QString name;
-    int i;
-    int j;
-    int rc = K_NONE;
-    char *tmp = (char*)p;
-
-    /* printf ("match_keyword\n"); */
+    return s.mid(keywordLength(s, kw)).trimmed();
+}
 
-    for (i = 0; i < kw->token.length(); i++)
-    {
-        if (tolower (p[i]) != kw->token[i])
-            return rc;
+/* Find the first byte, word, or long in s. */
+static int findSizeType(const QByteArray &s)
+{
+    static const char *types[] = { "byte", "long", "word", NULL };
+    const char *p = s.constData();
+    int len = s.length();
+    for(int n = 0; n+4 <= len; n++) {
+        if(n > 0 && isWordChar(p[n-1]))
+            continue;
+        if(n+4 < len && isWordChar(p[n+4]))
+            continue;
+        for(int t = 0; types[t] != NULL; t++) {
+            if(qstrnicmp(p+n, types[t], 4) == 0)
+                return n;
+        }
     }
+    return -1;
+}
 
-    p += i;
-    if(*p && !isspace(*p))
-        return K_NONE;
-
-    /* if p stands alone on the line, don't add it */
-    if(strlen(p) == 0)
-         return tokentype(tmp);
-
-    for (j = 0; j < 1 + kw->skip; j++)
+/* Match a section keyword at the start of the line (case insensitive). */
+int SpinParser::match_keyword (const QByteArray &p)
+{
+    for (int i = 0; spin_keywords[i].token != NULL; i++)
     {
-        p = extract_name (p, name);
+        if (keywordLength(p, spin_keywords[i].token) > 0)
+            return spin_keywords[i].kind;
     }
-    /* printf ("match_keyword name %d %s\n", name->length, name->buffer); */
-
-    if(name.length() > 0) {
-        rc = tokentype(kw->token);
-        tag = name+"\t"+currentFile+"\t"+tmp+"\t"+SpinKinds[rc].letter;
-    }
-    return rc;
+    return K_NONE;
 }
 
-void SpinParser::match_constant (QString p)
+void SpinParser::match_constant (const QByteArray &p)
 {
-    QString tag("");
+    QByteArray s = skipKeyword(p, "con");
     int len;
     bool ok;
-    p = p.trimmed();
     // ENUM is a constant like #n, NAME, NAME2
-    if((p.indexOf("#")) == 0) {
-        // add to database
-        QString s = p.mid(1).trimmed();
-        QStringList list = s.split(",");
-        for(int n = 0; n < list.count(); n++) {
-            s = QString(list[n]).trimmed();
+    if(s.startsWith('#')) {
+        QList<QByteArray> list = s.mid(1).split(',');
+        foreach(s, list) {
+            s = s.trimmed();
             s.toInt(&ok);  // don't add numbers to the list
             if(ok == true) continue;
-            tag = s+"\t"+currentFile+"\t"+p+"\t"+"e";
-            db.insert(objectNode+KEY_ELEMENT_SEP+s,tag);
-            // qDebug() << objectNode << " ## " << tag;
+            addSymbol(s, p, 'e');
         }
     }
-    else if((len = p.indexOf("=")) > 0) {
-        if(p.contains(QRegExp("\\b?=\\b")))
-            len = 0;
-        if(len > 0) {
-            // add to database
-            QString s = p.mid(0,len).trimmed();
-            if(s.indexOf("con",0,Qt::CaseInsensitive) == 0)
-                s = s.mid(4);
-            s = s.trimmed();
-            tag = s+"\t"+currentFile+"\t"+p+"\t"+SpinKinds[K_CONST].letter;
-            db.insert(objectNode+KEY_ELEMENT_SEP+s,tag);
-            // qDebug() << objectNode << " ## " << tag;
+    else if((len = s.indexOf('=')) > 0) {
+        // an = followed by a word is an expression, not a declaration
+        for(int n = len; n >= 0; n = s.indexOf('=', n+1)) {
+            if(n+1 < s.length() && isWordChar(s.at(n+1)))
+                return;
         }
+        addSymbol(s.left(len).trimmed(), p, SpinKinds[K_CONST].letter);
     }
 }
 
-void SpinParser::match_dat (QString p)
+void SpinParser::match_dat (const QByteArray &p)
 {
-    QString tag = "";
-    QString s = p.trimmed();
-    if(s.indexOf("dat",0,Qt::CaseInsensitive) == 0)
-        s = s.mid(4);
-    s = s.trimmed();
-    QRegExp regex("\\b(byte|long|word)\\b");
-    regex.setCaseSensitivity(Qt::CaseInsensitive);
-    if(s.contains(regex)) {
-        s = s.mid(0,s.indexOf(regex));
-        s = s.trimmed();
-        QStringList list = s.split(",",QString::SkipEmptyParts);
-        if(list.length() > 0) {
-            foreach(s,list) {
-                if(s.contains("["))
-                    s = s.mid(0,s.indexOf("["));
-                s = s.trimmed();
-                tag = s+"\t"+currentFile+"\t"+p+"\t"+SpinKinds[K_DAT].letter;
-                db.insert(objectNode+KEY_ELEMENT_SEP+s,tag);
-                // qDebug() << objectNode << " DAT " << tag;
-            }
-        }
+    QByteArray s = skipKeyword(p, "dat");
+    int type = findSizeType(s);
+    if(type < 0)
+        return;
+    QList<QByteArray> list = s.left(type).split(',');
+    foreach(s, list) {
+        if(s.contains('['))
+            s = s.left(s.indexOf('['));
+        addSymbol(s.trimmed(), p, SpinKinds[K_DAT].letter);
     }
 }
 
-void SpinParser::match_object (QString p)
-{
-    QString tag = "";
-    QString subfile = "";
-    QString subnode = "";
-    int len = p.indexOf(":");
-    if(p.indexOf(":=") > 0)
-        len = 0;
-    if(len > 0) {
-        // add to database
-        QString s = p.mid(0,len);
-        if(s.contains("OBJ",Qt::CaseInsensitive))
-            s = s.mid(s.indexOf("OBJ",0,Qt::CaseInsensitive)+3);
-        if(s.contains("[",Qt::CaseInsensitive))
-            s = s.mid(0,s.indexOf("[",0,Qt::CaseInsensitive));
-        s = s.trimmed();
-        tag = s+"\t"+currentFile+"\t"+p+"\t"+SpinKinds[K_OBJECT].letter;
-        objectInfo(tag, subnode, subfile);
-        QString file = checkFile(subfile);
-        if(QFile::exists(file) == false)
-            return;
-        db.insert(objectNode+"/"+subnode+KEY_ELEMENT_SEP+s,tag);
-        // qDebug() << objectNode+"/"+subnode << " :: " << tag;
-        findSpinTags(subfile,objectNode+"/"+subnode);
-    }
+void SpinParser::match_object (const QByteArray &p)
+{
+    int len = p.indexOf(':');
+    if(len <= 0 || p.contains(":="))
+        return;
+    QByteArray s = skipKeyword(p.left(len), "obj");
+    if(s.contains('['))
+        s = s.left(s.indexOf('['));
+    s = s.trimmed();
+    if(s.isEmpty())
+        return;
+    Symbol sym;
+    sym.name = QString::fromUtf8(s);
+    sym.tag = sym.name+"\t"+currentFile+"\t"+QString::fromUtf8(p)+"\t"+QChar(SpinKinds[K_OBJECT].letter);
+    /* the sub-file is resolved when the tree is built */
+    objectInfo(sym.tag, sym.subnode, sym.subfile);
+    parseList->append(sym);
 }
 
-void SpinParser::match_pri (QString p)
-{
-    QString tag("");
-    int len = p.indexOf("pri",0,Qt::CaseInsensitive);
-    if(len == 0) {
-        // add to database
-        QString s = p.mid(4);
-        if(s.indexOf("|") >= 0)
-            s = s.mid(0,s.indexOf("|"));
-        if(s.indexOf(":") >= 0)
-            s = s.mid(0,s.indexOf(":"));
-        if(s.indexOf("(") >= 0)
-            s = s.mid(0,s.indexOf("("));
-        s = s.trimmed();
-        tag = s+"\t"+currentFile+"\t"+p+"\t"+SpinKinds[K_PRI].letter;
-        db.insert(objectNode+KEY_ELEMENT_SEP+s,tag);
-        // qDebug() << objectNode << " pri " << tag;
-    }
+/* match a pub or pri method name */
+void SpinParser::match_method (const QByteArray &p, SpinKind kind)
+{
+    int len = keywordLength(p, kind == K_PUB ? "pub" : "pri");
+    if(len == 0)
+        return;
+    QByteArray s = p.mid(len);
+    if(s.indexOf('|') >= 0)
+        s = s.left(s.indexOf('|'));
+    if(s.indexOf(':') >= 0)
+        s = s.left(s.indexOf(':'));
+    if(s.indexOf('(') >= 0)
+        s = s.left(s.indexOf('('));
+    addSymbol(s.trimmed(), p, SpinKinds[kind].letter);
 }
 
-void SpinParser::match_pub (QString p)
-{
-    QString tag("");
-    int len = p.indexOf("pub",0,Qt::CaseInsensitive);
-    if(len == 0) {
-        // add to database
-        QString s = p.mid(4);
-        if(s.indexOf("|") >= 0)
-            s = s.mid(0,s.indexOf("|"));
-        if(s.indexOf(":") >= 0)
-            s = s.mid(0,s.indexOf(":"));
-        if(s.indexOf("(") >= 0)
-            s = s.mid(0,s.indexOf("("));
-        s = s.trimmed();
-        tag = s+"\t"+currentFile+"\t"+p+"\t"+SpinKinds[K_PUB].letter;
-        db.insert(objectNode+KEY_ELEMENT_SEP+s,tag);
-        // qDebug() << objectNode << " pub " << tag;
+void SpinParser::match_var (const QByteArray &p)
+{
+    QByteArray s = skipKeyword(p, "var");
+    if(findSizeType(s) != 0)
+        return;
+    QList<QByteArray> list = s.mid(4).split(',');
+    foreach(s, list) {
+        if(s.contains('['))
+            s = s.left(s.indexOf('['));
+        addSymbol(s.trimmed(), p, SpinKinds[K_VAR].letter);
     }
 }
 
-void SpinParser::match_var (QString p)
+void SpinParser::addSymbol(const QByteArray &name, const QByteArray &decl, char letter)
 {
-    QString tag = "";
-    QString s = p.trimmed();
-    if(s.indexOf("var",0,Qt::CaseInsensitive) == 0)
-        s = s.mid(4);
-    s = s.trimmed();
-    QRegExp regex("\\b(byte|long|word)\\b");
-    regex.setCaseSensitivity(Qt::CaseInsensitive);
-    if(s.contains(regex)) {
-        QString s = p.trimmed();
-        if(s.indexOf("var",0,Qt::CaseInsensitive) == 0)
-            s = s.mid(4);
-        s = s.trimmed();
-        if(s.indexOf(regex) == 0) {
-            s = s.mid(s.indexOf(regex)+4);
-            QStringList list = s.split(",",QString::SkipEmptyParts);
-            if(list.length() > 0) {
-                foreach(s,list) {
-                    if(s.contains("["))
-                        s = s.mid(0,s.indexOf("["));
-                    s = s.trimmed();
-                    tag = s+"\t"+currentFile+"\t"+p+"\t"+SpinKinds[K_VAR].letter;
-                    db.insert(objectNode+KEY_ELEMENT_SEP+s,tag);
-                    // qDebug() << objectNode << " VAR " << tag;
-                }
-            }
-        }
-    }
+    if(name.isEmpty())
+        return;
+    Symbol sym;
+    sym.name = QString::fromUtf8(name);
+    sym.tag = sym.name+"\t"+currentFile+"\t"+QString::fromUtf8(decl)+"\t"+QChar(letter);
+    parseList->append(sym);
 }
 
 int SpinParser::objectInfo(QString tag, QString &name, QString &file)
@@ -555,6 +492,21 @@ int SpinParser::objectInfo(QString tag, QString &name, QString &file)
     return list.length();
 }
 
+/*
+ * Directory listings are only read again when the directory changes.
+ */
+QStringList SpinParser::dirEntries(QString path)
+{
+    QDateTime modified = QFileInfo(path).lastModified();
+    QHash<QString, DirEntries>::iterator it = dirCache.find(path);
+    if(it == dirCache.end() || it->modified != modified) {
+        DirEntries entries;
+        entries.modified = modified;
+        entries.list = QDir(path).entryList();
+        it = dirCache.insert(path, entries);
+    }
+    return it->list;
+}
 
 QString SpinParser::checkFile(QString fileName)
 {
@@ -567,20 +519,17 @@ QString SpinParser::checkFile(QString fileName)
         return libraryPath+fileName;
     }
     else {
-        QDir dir;
         QStringList list;
         QString fs = this->currentFile;
         QString shortfile = fileName.mid(fileName.lastIndexOf("/")+1);
         QString path = fs.mid(0,fs.lastIndexOf("/")+1);
-        dir.setPath(path);
-        list = dir.entryList();
+        list = dirEntries(path);
         foreach(QString s, list) {
             if(s.compare(shortfile,Qt::CaseInsensitive) == 0) {
                 return path+s;
             }
         }
-        dir.setPath(libraryPath);
-        list = dir.entryList();
+        list = dirEntries(libraryPath);
         foreach(QString s, list) {
             if(s.contains(shortfile,Qt::CaseInsensitive)) {
                 return libraryPath+"/"+s;
@@ -590,126 +539,164 @@ QString SpinParser::checkFile(QString fileName)
     return retfile;
 }
 
+void SpinParser::setBuffers(QHash<QString, QByteArray> buffers)
+{
+    editBuffers.clear();
+    QHash<QString, QByteArray>::const_iterator it;
+    for(it = buffers.constBegin(); it != buffers.constEnd(); ++it)
+        editBuffers.insert(QDir::cleanPath(it.key()), it.value());
+}
+
+/*
+ * Get the symbols of one file. A file is parsed again only when its
+ * time stamp or size changes, so library objects shared by many
+ * objects or projects are parsed once. Files with an editor buffer
+ * are parsed again only when the buffer changes.
+ */
+QList<SpinParser::Symbol> SpinParser::spinFileSymbols(QString fileName)
+{
+    QHash<QString, QByteArray>::const_iterator buffer = editBuffers.constFind(QDir::cleanPath(fileName));
+    QHash<QString, ParsedFile>::const_iterator it = parseCache.constFind(fileName);
+    bool cached = it != parseCache.constEnd();
+
+    ParsedFile parsed;
+    if(buffer != editBuffers.constEnd()) {
+        parsed.size = buffer->size();
+        parsed.bufferHash = qHash(*buffer);
+        if(cached && it->modified.isNull() &&
+           it->size == parsed.size && it->bufferHash == parsed.bufferHash) {
+            return it->symbols;
+        }
+    }
+    else {
+        QFileInfo info(fileName);
+        parsed.modified = info.lastModified();
+        parsed.size = info.size();
+        parsed.bufferHash = 0;
+        if(cached && !it->modified.isNull() &&
+           it->modified == parsed.modified && it->size == parsed.size) {
+            return it->symbols;
+        }
+    }
+
+    parseList = &parsed.symbols;
+    currentFile = fileName;
+    if(buffer != editBuffers.constEnd())
+        parseSpinBuffer(*buffer);
+    else
+        parseSpinFile(fileName);
+    parseList = NULL;
+    parseCache.insert(fileName, parsed);
+    return parsed.symbols;
+}
+
+/*
+ * Add the symbols of a file and its sub-objects to the db under objnode.
+ */
 void SpinParser::findSpinTags (QString fileName, QString objnode)
 {
     fileName = checkFile(fileName);
     if(QFile::exists(fileName) == false)
         return;
 
-    QString line;
-    QString tag;
-    QString filestr;
+    QList<Symbol> symbols = spinFileSymbols(fileName);
+    foreach(Symbol sym, symbols) {
+        if(sym.subfile.isEmpty()) {
+            db.insert(objnode+KEY_ELEMENT_SEP+sym.name, sym.tag);
+            continue;
+        }
+        // sub-file names are relative to this file
+        currentFile = fileName;
+        QString file = checkFile(sym.subfile);
+        if(QFile::exists(file) == false)
+            continue;
+        db.insert(objnode+"/"+sym.subnode+KEY_ELEMENT_SEP+sym.name, sym.tag);
+        findSpinTags(sym.subfile, objnode+"/"+sym.subnode);
+    }
+}
 
-    SpinKind state = K_CONST; // spin starts with CONST
-    bool blockComment = false;
+/*
+ * Spin files are UTF-16 when they have a byte order mark, else they
+ * are read like QTextStream would. The parser works on UTF-8.
+ */
+QByteArray SpinParser::spinText(const QByteArray &bytes)
+{
+    QTextCodec *codec = QTextCodec::codecForUtfText(bytes, 0);
+    if(codec == 0)
+        codec = QTextCodec::codecForLocale();
+    if(codec->mibEnum() == 106) { // UTF-8
+        if(bytes.startsWith("\xEF\xBB\xBF"))
+            return bytes.mid(3);
+        return bytes;
+    }
+    return codec->toUnicode(bytes).toUtf8();
+}
 
+void SpinParser::parseSpinFile (QString fileName)
+{
     QFile file(fileName);
-    QTextStream in(&file);
-    in.setAutoDetectUnicode(true);
     if(file.open(QFile::ReadOnly) != true)
         return;
-    QStringList list;
-    QStringList lst2;
-
-    filestr = in.readAll();
+    QByteArray bytes = file.readAll();
     file.close();
 
-    list = filestr.split("\n",QString::SkipEmptyParts,Qt::CaseInsensitive);
-    lst2 = filestr.split("\r",QString::SkipEmptyParts,Qt::CaseInsensitive);
-
-    /* amazing that we have to do stuff like this with spin files */
-    if(lst2.count() > list.count())
-        list = filestr.split("\r",QString::SkipEmptyParts,Qt::CaseInsensitive);
+    parseSpinBuffer(spinText(bytes));
+}
 
-    for(int n = 0; n < list.length(); n++)
-    {
-        // give app a chance to do work? parsing can take a while.
-        // QApplication::processEvents();
+/*
+ * Parse Spin text in one pass over its bytes. Lines end with any of
+ * \n, \r\n, or \r. Block comments may span lines.
+ */
+void SpinParser::parseSpinBuffer (const QByteArray &text)
+{
+    SpinKind state = K_CONST; // spin starts with CONST
+    bool blockComment = false;
 
-        // do here in case OBJ detect causes context change
-        objectNode  = objnode;
-        currentFile = fileName;
+    const char *s = text.constData();
+    int len = text.length();
+    int start = 0;
+    QByteArray line;
 
-        line = QString(list[n]).trimmed();
+    for(int n = 0; n <= len; n++)
+    {
+        if(n < len && s[n] != '\n' && s[n] != '\r')
+            continue;
 
-        if(line.contains("{") || line.contains("}")) {
-            QString s = line;
-            line = "";
-            for(int j = 0; j < s.length(); j++) {
-                QChar c = s[j];
-                if(c == '{') {
-                    blockComment = true;
-                }
-                else if(c == '}') {
+        /* copy the line without comments */
+        line.resize(0);
+        for(int j = start; j < n; j++) {
+            char c = s[j];
+            if(blockComment) {
+                if(c == '}')
                     blockComment = false;
-                    j++;
-                }
-                if(blockComment == false)
-                    line += s[j];
             }
+            else if(c == '{')
+                blockComment = true;
+            else if(c == '\'')
+                break;
+            else
+                line += c;
         }
-        if(blockComment)
-            continue;
+        start = n+1;
 
-        if(line.contains("\'")) {
-            line = line.mid(0,line.indexOf("\'"));
-        }
+        line = line.trimmed();
 
         /* Empty line? */
-        if (line.length() < 1)
+        if (line.isEmpty())
             continue;
 
-#if !defined(SPIN_AUTOCOMPLETE)
         /* In Spin, keywords always are at the start of the line. */
-        SpinKind type = K_NONE;
-        KeyWord kw = spin_keywords[1]; // K_OBJECT is not 1, but OBJ keyword is.
-        line = line.trimmed();
-        QRegExp tokens("\\b(con|obj|pri|pub|dat|var)\\b");
-        tokens.setCaseSensitivity(Qt::CaseInsensitive);
-        if(line.indexOf(tokens) == 0) {
-            // if line has obj at position 0, get the type and store it
-            // else set to some other type so we stop looking for objects
-            if(line.indexOf("obj",0,Qt::CaseInsensitive) == 0)
-                type = (SpinKind) match_keyword (line.toLatin1(), &kw, tag);
-            else
-                type = this->K_CONST;
+        SpinKind type = (SpinKind) match_keyword (line);
 
-            // keep state until it changes from K_NONE
-            if(type != K_NONE) {
-                state = type;
-            }
-        }
+        // keep state until it changes from K_NONE
+        if(type != K_NONE)
+            state = type;
 
         //printf ("state %d\n", state);
-        switch(state) {
-            case K_OBJECT:
-                match_object(line);
-            break;
-            default:
-                tag = "";
-            break;
-        }
+#if !defined(SPIN_AUTOCOMPLETE)
+        if(state == K_OBJECT)
+            match_object(line);
 #else
-        /* In Spin, keywords always are at the start of the line. */
-        SpinKind type = K_NONE;
-        foreach(KeyWord kw, spin_keywords) {
-            if(kw.kind == K_NONE)
-                continue;
-            type = K_NONE;
-            line = line.trimmed();
-            if(line.indexOf(kw.token,0,Qt::CaseInsensitive) == 0) {
-                // if line has a token, get the type and store it
-                type = (SpinKind) match_keyword (line.toLatin1(), &kw, tag);
-
-                // keep state until it changes from K_NONE
-                if(type != K_NONE) {
-                    state = type;
-                    break;
-                }
-            }
-        }
-
-        //printf ("state %d\n", state);
         switch(state) {
             case K_CONST:
                 match_constant(line);
@@ -721,16 +708,13 @@ void SpinParser::findSpinTags (QString fileName, QString objnode)
                 match_object(line);
             break;
             case K_PRI:
-                match_pri(line);
-            break;
             case K_PUB:
-                match_pub(line);
+                match_method(line, state);
             break;
             case K_VAR:
                 match_var(line);
             break;
             default:
-                tag = "";
             break;
         }
 #endif
@@ -54,6 +54,18 @@ public:
      */
     QStringList spinFileTree(QString file, QString libpath);
 
+    /* parse a project into the symbol table without building a file list */
+    void parseTree(QString file, QString libpath);
+
+    /* the symbol table from the last parse. see db below */
+    QMap<QString, QString> symbolTable();
+
+    /*
+     * Unsaved editor contents by file path, UTF-8 encoded.
+     * A file with a buffer is parsed from the buffer instead of the disk.
+     */
+    void setBuffers(QHash<QString, QByteArray> buffers);
+
     /* build a tag item */
     QString tagItem(QStringList tabs, int field);
 
@@ -92,7 +104,7 @@ private:
     } kindOption;
 
     typedef struct {
-        QString token;
+        const char *token;
         SpinParser::SpinKind kind;
         int skip;
     } KeyWord;
@@ -100,15 +112,45 @@ private:
     kindOption SpinKinds[K_KINDS];
     QList<KeyWord> spin_keywords;
 
+    /* a symbol found in one file. objects also have a sub-file */
+    typedef struct {
+        QString name;
+        QString tag;
+        QString subnode;
+        QString subfile;
+    } Symbol;
+
+    /* symbols of a file as of the last time it was parsed */
+    typedef struct {
+        QDateTime modified;
+        qint64    size;
+        uint      bufferHash;   /* set if parsed from an editor buffer */
+        QList<Symbol> symbols;
+    } ParsedFile;
+
+    typedef struct {
+        QDateTime modified;
+        QStringList list;
+    } DirEntries;
+
+    /* parsed files by path, kept across trees and projects */
+    QHash<QString, ParsedFile> parseCache;
+
+    /* unsaved editor contents by path */
+    QHash<QString, QByteArray> editBuffers;
+
+    /* directory listings used to resolve object file names */
+    QHash<QString, DirEntries> dirCache;
+
+    /* symbol list being filled by the match functions */
+    QList<Symbol> *parseList;
+
     /* this holds the spin project file list */
     QStringList spinFiles;
 
     /* this holds the current working spin file */
     QString     currentFile;
 
-    /* this holds the current working tree node */
-    QString     objectNode;
-
     /*
      * This holds a list of all project symbols.
      * The key is a name-path key such as root/obj/subobj/subsubobj/name
@@ -126,18 +168,20 @@ private:
 
     void setKind(kindOption *kind, bool en, const char letter, const char *type, const char *desc);
 
-    const char *extract_name (char const *pos, QString &name);
-    int  tokentype(QString tmp);
-    int  match_keyword (const char *p, KeyWord const *kw, QString &tag);
-    int  spintype(char const *p);
-    void match_constant (QString p);
-    void match_dat (QString p);
-    void match_object (QString p);
-    void match_pri (QString p);
-    void match_pub (QString p);
-    void match_var (QString p);
+    int  match_keyword (const QByteArray &p);
+    void match_constant (const QByteArray &p);
+    void match_dat (const QByteArray &p);
+    void match_object (const QByteArray &p);
+    void match_method (const QByteArray &p, SpinKind kind);
+    void match_var (const QByteArray &p);
+    void addSymbol(const QByteArray &name, const QByteArray &decl, char letter);
     int objectInfo(QString tag, QString &name, QString &file);
+    QStringList dirEntries(QString path);
     QString checkFile(QString fileName);
+    QList<Symbol> spinFileSymbols(QString fileName);
+    QByteArray spinText(const QByteArray &bytes);
+    void parseSpinFile(QString fileName);
+    void parseSpinBuffer(const QByteArray &text);
     void findSpinTags (QString fileName, QString objnode);
 
 };
@@ -23,6 +23,9 @@
 #define TERM_ENABLE_BUTTON
 //#endif
 
+// capture byte counter update period
+#define CAPTURE_STATUS_MSECS 500
+
 Terminal::Terminal(QWidget *parent) : QDialog(parent), portListener(NULL), lastConnectedPortName("")
 {
     termEditor = new Console(parent);
@@ -72,6 +75,27 @@ void Terminal::init()
     buttonOpt->setAutoDefault(false);
     buttonOpt->setDefault(false);
 
+    buttonCapture = new QPushButton(tr("Capture"),this);
+    QMenu *captureMenu = new QMenu(buttonCapture);
+    captureAction = captureMenu->addAction(tr("Start Capture..."), this, SLOT(toggleCapture()));
+    captureMenu->addSeparator();
+    stampAction = captureMenu->addAction(tr("Timestamp Chunks"));
+    stampAction->setCheckable(true);
+    mapAction = captureMenu->addAction(tr("Memory-mapped File"));
+    mapAction->setCheckable(true);
+    buttonCapture->setMenu(captureMenu);
+    buttonCapture->setAutoDefault(false);
+    buttonCapture->setDefault(false);
+
+    QSettings settings(publisherKey, ASideGuiKey);
+    stampAction->setChecked(settings.value(termKeyCaptureStamps, false).toBool());
+    mapAction->setChecked(settings.value(termKeyCaptureMapped, false).toBool());
+
+    captureLast = 0;
+    captureLabel.hide();
+    captureTimer.setInterval(CAPTURE_STATUS_MSECS);
+    connect(&captureTimer, SIGNAL(timeout()), this, SLOT(captureStatus()));
+
 #ifdef TERM_ENABLE_BUTTON
     buttonEnable = new QPushButton(tr("Disable"),this);
     connect(buttonEnable,SIGNAL(clicked()), this, SLOT(toggleEnable()));
@@ -93,6 +117,8 @@ void Terminal::init()
 #ifdef TERM_ENABLE_BUTTON
     butLayout->addWidget(buttonEnable);
 #endif
+    butLayout->addWidget(buttonCapture);
+    butLayout->addWidget(&captureLabel);
     butLayout->addWidget(comboBoxBaud);
     butLayout->addWidget(&portLabel);
     portLabel.setFont(QFont("System", 14));
@@ -114,6 +140,7 @@ Console *Terminal::getEditor()
 void Terminal::setPortListener(PortListener *listener)
 {
     portListener = listener;
+    listener->setCaptureFile(&capture);
     if(listener->getPortName().isEmpty() == false)
         portLabel.setText(listener->getPortName());
     else
@@ -202,6 +229,7 @@ void Terminal::accept()
     }
     termEditor->setPortEnable(false);
     portLabel.setEnabled(false);
+    stopCapture();
     done(QDialog::Accepted);
 }
 
@@ -216,6 +244,7 @@ void Terminal::reject()
     settings->setValue(termGeometryKey,geo);
     termEditor->setPortEnable(false);
     portLabel.setEnabled(false);
+    stopCapture();
     done(QDialog::Rejected);
 }
 
@@ -301,3 +330,84 @@ void Terminal::showOptions()
 {
     options->showDialog();
 }
+
+static QString byteCountText(double bytes)
+{
+    if(bytes >= 1024.0*1024.0)
+        return QString("%1 MB").arg(bytes/(1024.0*1024.0), 0, 'f', 1);
+    if(bytes >= 1024.0)
+        return QString("%1 KB").arg(bytes/1024.0, 0, 'f', 1);
+    return QString("%1 B").arg((qint64)bytes);
+}
+
+/*
+ * Start recording received bytes to a file, or stop if already recording.
+ * The PortListener thread writes the file; the terminal only shows a preview.
+ */
+void Terminal::toggleCapture()
+{
+    if(capture.isOpen()) {
+        stopCapture();
+        return;
+    }
+
+    QSettings settings(publisherKey, ASideGuiKey);
+    QString last = settings.value(termKeyCaptureFile, QDir::homePath()+"/capture.bin").toString();
+    QString name = QFileDialog::getSaveFileName(this, tr("Capture Serial Data"), last,
+                        tr("Capture Files (*.bin *.log);;All Files (*)"));
+    if(name.isEmpty())
+        return;
+
+    settings.setValue(termKeyCaptureFile, name);
+    settings.setValue(termKeyCaptureStamps, stampAction->isChecked());
+    settings.setValue(termKeyCaptureMapped, mapAction->isChecked());
+
+    if(!capture.open(name, stampAction->isChecked(), mapAction->isChecked())) {
+        QMessageBox::critical(this, tr("Capture"),
+                tr("Can't open %1 for capture.").arg(name)+"\n"+capture.errorString());
+        return;
+    }
+
+    captureLast = 0;
+    captureClock.start();
+    captureAction->setText(tr("Stop Capture"));
+    stampAction->setEnabled(false);
+    mapAction->setEnabled(false);
+    captureLabel.setText(byteCountText(0));
+    captureLabel.show();
+    captureTimer.start();
+}
+
+void Terminal::stopCapture()
+{
+    captureTimer.stop();
+    capture.close();
+    captureAction->setText(tr("Start Capture..."));
+    stampAction->setEnabled(true);
+    mapAction->setEnabled(true);
+    captureLabel.hide();
+}
+
+/*
+ * Show bytes captured and the rate since the last update.
+ */
+void Terminal::captureStatus()
+{
+    if(!capture.isOpen()) {
+        QString error = capture.errorString();
+        QString name = capture.fileName();
+        stopCapture();
+        if(error.length() > 0)
+            QMessageBox::critical(this, tr("Capture"),
+                    tr("Capture to %1 stopped.").arg(name)+"\n"+error);
+        return;
+    }
+
+    qint64 bytes = capture.bytesWritten();
+    int msecs = captureClock.restart();
+    double rate = 0;
+    if(msecs > 0)
+        rate = (bytes-captureLast)*1000.0/msecs;
+    captureLast = bytes;
+    captureLabel.setText(byteCountText(bytes)+"  "+byteCountText(rate)+"/s");
+}
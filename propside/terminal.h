@@ -66,6 +66,9 @@ public slots:
     void cutFromFile();
     void pasteToFile();
     void showOptions();
+    void toggleCapture();
+    void stopCapture();
+    void captureStatus();
 
 public:
     Console *getEditor();
@@ -76,6 +79,16 @@ private:
     QCheckBox   *cbEchoOn;
     QLabel      portLabel;
 
+    QPushButton *buttonCapture;
+    QAction     *captureAction;
+    QAction     *stampAction;
+    QAction     *mapAction;
+    QLabel      captureLabel;
+    QTimer      captureTimer;
+    QTime       captureClock;
+    qint64      captureLast;
+    CaptureFile capture;
+
 private:
     QPushButton     *buttonEnable;
     PortListener    *portListener;
@@ -307,8 +307,8 @@ void TermPrefs::saveSettings()
      */
     int lineindex = ui->comboBoxBufferLines->currentIndex();
     int lines = 512;
-    settings->setValue(termKeyBufferLines,lineindex);
     QString s = ui->comboBoxBufferLines->itemText(lineindex);
+    settings->setValue(termKeyScrollbackLines,s);
     if(s.contains("infinite",Qt::CaseInsensitive)) {
         lines = 0; // 0 or -1 says buffer is infinite
     }
@@ -572,11 +572,26 @@ void TermPrefs::readSettings()
     /*
      * read number of lines for buffer
      */
-    int lineindex = 6;
+    int lineindex = -1;
     int lines = 2048;
-    var = settings->value(termKeyBufferLines,QVariant(6));
-    if(var.canConvert(QVariant::Int)) {
-        lineindex = var.toInt();
+    var = settings->value(termKeyScrollbackLines);
+    if(var.canConvert(QVariant::String)) {
+        lineindex = ui->comboBoxBufferLines->findText(var.toString());
+    }
+    if(lineindex < 0) {
+        /* older versions saved the index into 32 .. 2048, Infinite */
+        var = settings->value(termKeyBufferLines,QVariant(6));
+        if(var.canConvert(QVariant::Int)) {
+            int old = var.toInt();
+            if(old >= 7)
+                lineindex = ui->comboBoxBufferLines->findText("Infinite");
+            else if(old >= 0)
+                lineindex = ui->comboBoxBufferLines->findText(QString::number(32 << old));
+        }
+    }
+    if(lineindex < 0)
+        lineindex = ui->comboBoxBufferLines->findText(QString::number(lines));
+    if(lineindex >= 0) {
         ui->comboBoxBufferLines->setCurrentIndex(lineindex);
         QString s = ui->comboBoxBufferLines->itemText(lineindex);
 
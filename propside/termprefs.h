@@ -61,6 +61,10 @@ class TermPrefs;
 #define termKeyWrapMode             appNameKey "_termWrapMode"
 #define termKeyPageLineSize         appNameKey "_termPageLineSize"
 #define termKeyBufferLines          appNameKey "_termBufferLines"
+#define termKeyScrollbackLines      appNameKey "_termScrollbackLines"
+#define termKeyCaptureFile          appNameKey "_termCaptureFile"
+#define termKeyCaptureStamps        appNameKey "_termCaptureStamps"
+#define termKeyCaptureMapped        appNameKey "_termCaptureMapped"
 #define termKeyTabSize              appNameKey "_termTabSize"
 #define termKeyHexMode              appNameKey "_termHexMode"
 #define termKeyHexDump              appNameKey "_termHexDumpMode"
@@ -0,0 +1,200 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "termscreen.h"
+
+TermScreen::TermScreen()
+{
+    maxCount = 0;
+    head = 0;
+    used = 0;
+    resize(MIN_CAPACITY);
+    clear();
+}
+
+/*
+ * A screen always has at least one line for the cursor.
+ */
+void TermScreen::clear()
+{
+    for(int n = 0; n < used; n++)
+        ring[index(n)].clear();
+    head = 0;
+    used = 0;
+    append(QString());
+    dirty = 0;
+    dropped = 0;
+    reset = true;
+}
+
+void TermScreen::setText(const QString &text)
+{
+    QStringList list = text.split("\n");
+    clear();
+    used = 0;
+    int first = 0;
+    if(maxCount > 0 && list.count() > maxCount)
+        first = list.count()-maxCount;
+    for(int n = first; n < list.count(); n++)
+        append(list.at(n));
+    if(used == 0)
+        append(QString());
+}
+
+QString TermScreen::text(int from) const
+{
+    QString s;
+    for(int n = from; n < used; n++) {
+        if(n > from)
+            s += '\n';
+        s += at(n);
+    }
+    return s;
+}
+
+/*
+ * Keep at most max lines, 0 keeps everything. The ring is cut down to
+ * the limit so lowering it gives the memory back.
+ * Returns how many of the oldest lines were dropped.
+ */
+int TermScreen::setMaxLines(int max)
+{
+    maxCount = max > 0 ? max : 0;
+    int n = 0;
+    if(maxCount > 0) {
+        while(used > maxCount) {
+            evict();
+            n++;
+        }
+        if(ring.size() > maxCount)
+            resize(maxCount);
+    }
+    return n;
+}
+
+QString &TermScreen::line(int row)
+{
+    touch(row);
+    return ring[index(row)];
+}
+
+/*
+ * Insert a line before row. On a full screen the oldest line is dropped
+ * to make room, so rows after the insert move up by one.
+ * Returns how many lines were dropped.
+ */
+int TermScreen::insertLine(int row, const QString &text)
+{
+    int n = 0;
+    if(isFull()) {
+        evict();
+        n = 1;
+        row = row > 0 ? row-1 : 0;
+    }
+    touch(row);
+    append(text);
+    for(int r = used-1; r > row; r--)
+        qSwap(ring[index(r)], ring[index(r-1)]);
+    return n;
+}
+
+void TermScreen::removeLine(int row)
+{
+    touch(row > 0 ? row-1 : 0);
+    for(int r = row; r < used-1; r++)
+        qSwap(ring[index(r)], ring[index(r+1)]);
+    ring[index(used-1)].clear();
+    used--;
+    if(used == 0)
+        append(QString());
+}
+
+/*
+ * Keep the first rows lines.
+ */
+void TermScreen::truncate(int rows)
+{
+    if(rows < 1)
+        rows = 1;
+    if(rows >= used)
+        return;
+    touch(rows-1);
+    while(used > rows) {
+        ring[index(used-1)].clear();
+        used--;
+    }
+}
+
+void TermScreen::clean()
+{
+    dirty = used;
+    dropped = 0;
+    reset = false;
+}
+
+void TermScreen::touch(int row)
+{
+    if(row < dirty)
+        dirty = row;
+}
+
+/*
+ * Add a line at the bottom. The ring doubles when it fills, up to the
+ * line limit if there is one.
+ */
+void TermScreen::append(const QString &text)
+{
+    if(used >= ring.size()) {
+        int size = ring.size()*2;
+        if(maxCount > 0 && size > maxCount)
+            size = maxCount > used ? maxCount : used+1;
+        resize(size);
+    }
+    ring[index(used)] = text;
+    used++;
+}
+
+/*
+ * Drop the oldest line.
+ */
+void TermScreen::evict()
+{
+    ring[head].clear();
+    head = (head+1) % ring.size();
+    used--;
+    if(reset == false)
+        dropped++;
+    if(dirty > 0)
+        dirty--;
+}
+
+void TermScreen::resize(int capacity)
+{
+    if(capacity < used)
+        capacity = used;
+    if(capacity < 1)
+        capacity = 1;
+    if(capacity == ring.size() && head == 0)
+        return;
+    QVector<QString> tmp(capacity);
+    for(int n = 0; n < used; n++)
+        tmp[n] = ring.at(index(n));
+    ring = tmp;
+    head = 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TERMSCREEN_H
+#define TERMSCREEN_H
+
+#include <QtCore>
+
+/*
+ * TermScreen is the text model behind the serial Console.
+ *
+ * Received bytes are applied to the lines here instead of to the
+ * QTextDocument, and the model remembers the first line that changed
+ * and how many old lines were dropped off the top. The Console then
+ * copies only that part to the widget once per frame.
+ *
+ * Lines are kept in a ring. With a line limit set the ring never grows
+ * past the limit and adding a line to a full screen drops the oldest
+ * one in constant time, so a long capture uses constant memory.
+ */
+class TermScreen
+{
+public:
+    TermScreen();
+
+    void clear();
+    void setText(const QString &text);
+    QString text(int from = 0) const;
+
+    int  setMaxLines(int max);
+    int  maxLines() const               { return maxCount; }
+    bool isFull() const                 { return maxCount > 0 && used >= maxCount; }
+
+    int  count() const                  { return used; }
+    const QString &at(int row) const    { return ring.at(index(row)); }
+    QString &line(int row);
+
+    int  insertLine(int row, const QString &text = QString());
+    void removeLine(int row);
+    void truncate(int rows);
+
+    bool isDirty() const                { return reset || dropped > 0 || dirty < used; }
+    bool isReset() const                { return reset; }
+    int  dirtyFrom() const              { return dirty; }
+    int  evicted() const                { return dropped; }
+    void clean();
+
+private:
+    enum { MIN_CAPACITY = 64 };
+
+    int  index(int row) const           { return (head+row) % ring.size(); }
+    void touch(int row);
+    void append(const QString &text);
+    void evict();
+    void resize(int capacity);
+
+    QVector<QString> ring;
+    int  head;
+    int  used;
+    int  maxCount;
+    int  dirty;
+    int  dropped;
+    bool reset;
+};
+
+#endif // TERMSCREEN_H
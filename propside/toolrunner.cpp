@@ -0,0 +1,88 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "toolrunner.h"
+
+QList<ToolRunner*> ToolRunner::active;
+
+/*
+ * Create the runner after the owner connects its own process slots and
+ * before the process is started. Slots run in connection order, so the
+ * owner's flag is already updated when the runner wakes up to test it.
+ */
+ToolRunner::ToolRunner(QProcess *process, QObject *parent) : QObject(parent)
+{
+    this->process = process;
+    ended = false;
+
+    connect(process, SIGNAL(started()), this, SLOT(wake()));
+    connect(process, SIGNAL(readyReadStandardOutput()), this, SLOT(wake()));
+    connect(process, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(procEnded()));
+    connect(process, SIGNAL(error(QProcess::ProcessError)), this, SLOT(procEnded()));
+}
+
+ToolRunner::~ToolRunner()
+{
+    active.removeAll(this);
+    process->disconnect(this);
+}
+
+/*
+ * Return when *done is true or the process has ended.
+ */
+void ToolRunner::wait(bool *done)
+{
+    active.append(this);
+    while(*done == false && ended == false) {
+        loop.exec();
+    }
+    active.removeAll(this);
+}
+
+void ToolRunner::wake()
+{
+    loop.quit();
+}
+
+void ToolRunner::procEnded()
+{
+    ended = true;
+    loop.quit();
+}
+
+/*
+ * Make every waiting runner re-check its done flag.
+ */
+void ToolRunner::wakeAll()
+{
+    foreach(ToolRunner *runner, active) {
+        runner->wake();
+    }
+}
+
+/*
+ * Wait for a worker thread to finish while still handling events.
+ */
+void ToolRunner::waitThread(QThread *thread)
+{
+    QEventLoop loop;
+    connect(thread, SIGNAL(finished()), &loop, SLOT(quit()));
+    if(thread->isRunning())
+        loop.exec();
+}
@@ -0,0 +1,65 @@
+/*
+ * This file is part of the Parallax Propeller SimpleIDE development environment.
+ *
+ * Copyright (C) 2014 Parallax Incorporated
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOOLRUNNER_H
+#define TOOLRUNNER_H
+
+#include "qtversion.h"
+
+/*
+ * ToolRunner waits for an external tool without sleep-polling.
+ *
+ * The QProcess runs asynchronously and its owner's slots update a done
+ * flag as usual. wait() sits in a local event loop that is only woken by
+ * the process signals (started, output, finished, error), so the flag is
+ * checked the moment it can change instead of every 50 ms.
+ * wait() also returns once the process has ended even if the owner
+ * never set the flag, so a tool that fails to start can't hang the IDE.
+ *
+ * Code that sets a done flag from outside the process signals, for example
+ * a Stop button, must call ToolRunner::wakeAll() afterwards.
+ */
+class ToolRunner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ToolRunner(QProcess *process, QObject *parent = 0);
+    virtual ~ToolRunner();
+
+    void wait(bool *done);
+    bool processEnded() { return ended; }
+
+    static void wakeAll();
+    static void waitThread(QThread *thread);
+
+public slots:
+    void wake();
+
+private slots:
+    void procEnded();
+
+private:
+    QProcess   *process;
+    QEventLoop  loop;
+    bool        ended;
+
+    static QList<ToolRunner*> active;
+};
+
+#endif // TOOLRUNNER_H
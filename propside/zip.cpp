@@ -50,6 +50,11 @@
 #include <qendian.h>
 #include <qdebug.h>
 #include <qdir.h>
+#include <qfileinfo.h>
+#include <qhash.h>
+#include <qrunnable.h>
+#include <qsemaphore.h>
+#include <qthreadpool.h>
 
 #include <zlib.h>
 #include <QApplication>
@@ -85,6 +90,12 @@
 #  define S_IXOTH 0001
 #endif
 
+/* bytes read from a source device per deflate step */
+#define ZIP_CHUNK_SIZE (64*1024)
+
+/* files up to this size are compressed in memory on the thread pool */
+#define ZIP_PARALLEL_LIMIT (4*1024*1024)
+
 #if 0
 #define ZDEBUG qDebug
 #else
@@ -222,7 +233,7 @@ static int inflate(Bytef *dest, ulong *destLen, const Bytef *source, ulong sourc
     return err;
 }
 
-static int deflate (Bytef *dest, ulong *destLen, const Bytef *source, ulong sourceLen)
+static int deflate (Bytef *dest, ulong *destLen, const Bytef *source, ulong sourceLen, int level)
 {
     z_stream stream;
     int err;
@@ -237,7 +248,7 @@ static int deflate (Bytef *dest, ulong *destLen, const Bytef *source, ulong sour
     stream.zfree = (free_func)0;
     stream.opaque = (voidpf)0;
 
-    err = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    err = deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
     if (err != Z_OK) return err;
 
     err = deflate(&stream, Z_FINISH);
@@ -251,6 +262,42 @@ static int deflate (Bytef *dest, ulong *destLen, const Bytef *source, ulong sour
     return err;
 }
 
+static QByteArray deflateData(const QByteArray &contents, int level, bool *ok)
+{
+    QByteArray data;
+    ulong len = contents.length();
+    // shamelessly copied form zlib
+    len += (len >> 12) + (len >> 14) + 11;
+    int res;
+    *ok = true;
+    do {
+        data.resize(len);
+        res = deflate((uchar*)data.data(), &len, (const uchar*)contents.constData(), contents.length(), level);
+
+        switch (res) {
+        case Z_OK:
+            data.resize(len);
+            break;
+        case Z_MEM_ERROR:
+            qWarning("Zip: Z_MEM_ERROR: Not enough memory to compress file, skipping");
+            data.resize(0);
+            *ok = false;
+            break;
+        case Z_BUF_ERROR:
+            len *= 2;
+            break;
+        }
+    } while (res == Z_BUF_ERROR);
+    return data;
+}
+
+/* already compressed formats that AutoCompress stores as they are */
+static const char *compressedSuffixes[] = {
+    "zip", "gz", "tgz", "bz2", "xz", "7z", "jar",
+    "png", "jpg", "jpeg", "gif", "mp3", "mp4",
+    0
+};
+
 static QFile::Permissions modeToPermissions(quint32 mode)
 {
     QFile::Permissions ret;
@@ -443,6 +490,9 @@ public:
     void scanFiles();
 
     ZipReader::Status status;
+
+    /* entry index by file name, filled by scanFiles */
+    QHash<QString, int> nameIndex;
 };
 
 class ZipWriterPrivate : public ZipPrivate
@@ -452,17 +502,76 @@ public:
         : ZipPrivate(device, ownDev),
         status(ZipWriter::NoError),
         permissions(QFile::ReadOwner | QFile::WriteOwner),
-        compressionPolicy(ZipWriter::AlwaysCompress)
+        compressionPolicy(ZipWriter::AlwaysCompress),
+        compressionLevel(Z_DEFAULT_COMPRESSION),
+        progress(0)
     {
     }
 
     ZipWriter::Status status;
     QFile::Permissions permissions;
     ZipWriter::CompressionPolicy compressionPolicy;
+    int compressionLevel;
+    ZipWriter::Progress *progress;
 
     enum EntryType { Directory, File, Symlink };
 
+    ZipWriter::CompressionPolicy compressionFor(const QString &fileName, qint64 size) const;
+    void setHeader(FileHeader &header, EntryType type, const QString &fileName);
+    void writeEntry(EntryType type, const QString &fileName, const QByteArray &data,
+                    uint crc_32, qint64 size, bool deflated);
     void addEntry(EntryType type, const QString &fileName, const QByteArray &contents);
+    void addStream(const QString &fileName, QIODevice *source);
+    void addFiles(const QStringList &fileNames, const QStringList &sources);
+};
+
+/*
+ * Reads and compresses one file on the thread pool. The writer waits
+ * on done and writes the result in archive order.
+ */
+class DeflateTask : public QRunnable
+{
+public:
+    DeflateTask(const QString &path, bool compress, bool autoStore, int level)
+        : path(path), compress(compress), autoStore(autoStore), level(level),
+          ok(false), deflated(false), crc_32(0), size(0)
+    {
+        setAutoDelete(false);
+    }
+
+    void run()
+    {
+        QFile file(path);
+        if (file.open(QIODevice::ReadOnly)) {
+            QByteArray contents = file.readAll();
+            file.close();
+            size = contents.length();
+            crc_32 = ::crc32(0, 0, 0);
+            crc_32 = ::crc32(crc_32, (const uchar *)contents.constData(), contents.length());
+            data = contents;
+            ok = true;
+            if (compress) {
+                QByteArray packed = deflateData(contents, level, &deflated);
+                if (deflated && !(autoStore && packed.length() >= contents.length()))
+                    data = packed;
+                else
+                    deflated = false;
+            }
+        }
+        done.release();
+    }
+
+    QString path;
+    bool compress;
+    bool autoStore;
+    int level;
+
+    bool ok;
+    bool deflated;
+    uint crc_32;
+    qint64 size;
+    QByteArray data;
+    QSemaphore done;
 };
 
 LocalFileHeader CentralFileHeader::toLocalHeader() const
@@ -566,73 +675,18 @@ void ZipReaderPrivate::scanFiles()
         }
 
         ZDEBUG("found file '%s'", header.file_name.data());
+        nameIndex.insert(QString::fromLocal8Bit(header.file_name), fileHeaders.count());
         fileHeaders.append(header);
     }
 }
 
-void ZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const QByteArray &contents/*, QFile::Permissions permissions, Zip::Method m*/)
+void ZipWriterPrivate::setHeader(FileHeader &header, EntryType type, const QString &fileName)
 {
-#ifndef NDEBUG
-    static const char *entryTypes[] = {
-        "directory",
-        "file     ",
-        "symlink  " };
-    ZDEBUG() << "adding" << entryTypes[type] <<":" << fileName.toUtf8().data() << (type == 2 ? QByteArray(" -> " + contents).constData() : "");
-#endif
-
-    if (! (device->isOpen() || device->open(QIODevice::WriteOnly))) {
-        status = ZipWriter::FileOpenError;
-        return;
-    }
-    device->seek(start_of_directory);
-
-    // don't compress small files
-    ZipWriter::CompressionPolicy compression = compressionPolicy;
-    if (compressionPolicy == ZipWriter::AutoCompress) {
-        if (contents.length() < 64)
-            compression = ZipWriter::NeverCompress;
-        else
-            compression = ZipWriter::AlwaysCompress;
-    }
-
-    FileHeader header;
     memset(&header.h, 0, sizeof(CentralFileHeader));
     writeUInt(header.h.signature, 0x02014b50);
 
     writeUShort(header.h.version_needed, 0x14);
-    writeUInt(header.h.uncompressed_size, contents.length());
     writeMSDosDate(header.h.last_mod_file, QDateTime::currentDateTime());
-    QByteArray data = contents;
-    if (compression == ZipWriter::AlwaysCompress) {
-        writeUShort(header.h.compression_method, 8);
-
-       ulong len = contents.length();
-        // shamelessly copied form zlib
-        len += (len >> 12) + (len >> 14) + 11;
-        int res;
-        do {
-            data.resize(len);
-            res = deflate((uchar*)data.data(), &len, (const uchar*)contents.constData(), contents.length());
-
-            switch (res) {
-            case Z_OK:
-                data.resize(len);
-                break;
-            case Z_MEM_ERROR:
-                qWarning("Zip: Z_MEM_ERROR: Not enough memory to compress file, skipping");
-                data.resize(0);
-                break;
-            case Z_BUF_ERROR:
-                len *= 2;
-                break;
-            }
-        } while (res == Z_BUF_ERROR);
-    }
-// TODO add a check if data.length() > contents.length().  Then try to store the original and revert the compression method to be uncompressed
-    writeUInt(header.h.compressed_size, data.length());
-    uint crc_32 = ::crc32(0, 0, 0);
-    crc_32 = ::crc32(crc_32, (const uchar *)contents.constData(), contents.length());
-    writeUInt(header.h.crc_32, crc_32);
 
     header.file_name = fileName.toLocal8Bit();
     if (header.file_name.size() > 0xffff) {
@@ -653,7 +707,69 @@ void ZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const Q
     }
     writeUInt(header.h.external_file_attributes, mode << 16);
     writeUInt(header.h.offset_local_header, start_of_directory);
+}
 
+void ZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const QByteArray &contents/*, QFile::Permissions permissions, Zip::Method m*/)
+{
+#ifndef NDEBUG
+    static const char *entryTypes[] = {
+        "directory",
+        "file     ",
+        "symlink  " };
+    ZDEBUG() << "adding" << entryTypes[type] <<":" << fileName.toUtf8().data() << (type == 2 ? QByteArray(" -> " + contents).constData() : "");
+#endif
+
+    bool deflated = false;
+    QByteArray data = contents;
+    if (compressionFor(fileName, contents.length()) == ZipWriter::AlwaysCompress) {
+        data = deflateData(contents, compressionLevel, &deflated);
+        // keep the original if compression fails or doesn't help
+        if (!deflated)
+            data = contents;
+        else if (compressionPolicy == ZipWriter::AutoCompress && data.length() >= contents.length()) {
+            data = contents;
+            deflated = false;
+        }
+    }
+    uint crc_32 = ::crc32(0, 0, 0);
+    crc_32 = ::crc32(crc_32, (const uchar *)contents.constData(), contents.length());
+    writeEntry(type, fileName, data, crc_32, contents.length(), deflated);
+}
+
+/*
+ * Pick the compression for one file. AutoCompress stores small files
+ * and files that are already compressed.
+ */
+ZipWriter::CompressionPolicy ZipWriterPrivate::compressionFor(const QString &fileName, qint64 size) const
+{
+    if (compressionPolicy != ZipWriter::AutoCompress)
+        return compressionPolicy;
+    if (size < 64 || compressionLevel == 0)
+        return ZipWriter::NeverCompress;
+    QString suffix = QFileInfo(fileName).suffix().toLower();
+    for (int n = 0; compressedSuffixes[n] != 0; n++) {
+        if (suffix == QLatin1String(compressedSuffixes[n]))
+            return ZipWriter::NeverCompress;
+    }
+    return ZipWriter::AlwaysCompress;
+}
+
+void ZipWriterPrivate::writeEntry(EntryType type, const QString &fileName, const QByteArray &data,
+                                  uint crc_32, qint64 size, bool deflated)
+{
+    if (! (device->isOpen() || device->open(QIODevice::WriteOnly))) {
+        status = ZipWriter::FileOpenError;
+        return;
+    }
+    device->seek(start_of_directory);
+
+    FileHeader header;
+    setHeader(header, type, fileName);
+    if (deflated)
+        writeUShort(header.h.compression_method, 8);
+    writeUInt(header.h.uncompressed_size, size);
+    writeUInt(header.h.compressed_size, data.length());
+    writeUInt(header.h.crc_32, crc_32);
 
     fileHeaders.append(header);
 
@@ -665,6 +781,153 @@ void ZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const Q
     dirtyFileTree = true;
 }
 
+/*
+ * Add a file by reading source in ZIP_CHUNK_SIZE pieces and deflating
+ * each piece as it is read, so memory use does not depend on the file
+ * size. The local header is written first and patched with the crc and
+ * sizes at the end, which needs a seekable archive device.
+ */
+void ZipWriterPrivate::addStream(const QString &fileName, QIODevice *source)
+{
+    if (! (device->isOpen() || device->open(QIODevice::WriteOnly))) {
+        status = ZipWriter::FileOpenError;
+        return;
+    }
+    device->seek(start_of_directory);
+
+    qint64 size = source->isSequential() ? ZIP_CHUNK_SIZE : source->size();
+    ZipWriter::CompressionPolicy compression = compressionFor(fileName, size);
+
+    FileHeader header;
+    setHeader(header, File, fileName);
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(z_stream));
+    bool compress = (compression == ZipWriter::AlwaysCompress);
+    if (compress) {
+        if (deflateInit2(&stream, compressionLevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            qWarning("Zip: Z_MEM_ERROR: Not enough memory to compress file, storing");
+            compress = false;
+        }
+    }
+    if (compress)
+        writeUShort(header.h.compression_method, 8);
+
+    LocalFileHeader h = header.h.toLocalHeader();
+    device->write((const char *)&h, sizeof(LocalFileHeader));
+    device->write(header.file_name);
+
+    QByteArray in(ZIP_CHUNK_SIZE, 0);
+    QByteArray out(ZIP_CHUNK_SIZE, 0);
+    uint crc_32 = ::crc32(0, 0, 0);
+    qint64 total = 0;
+    qint64 written = 0;
+
+    for (;;) {
+        qint64 len = source->read(in.data(), in.size());
+        if (len < 0) {
+            status = ZipWriter::FileError;
+            len = 0;
+        }
+        bool last = (len == 0 || source->atEnd());
+
+        crc_32 = ::crc32(crc_32, (const uchar *)in.constData(), len);
+        total += len;
+
+        if (!compress) {
+            written += device->write(in.constData(), len);
+        }
+        else {
+            stream.next_in = (Bytef*)in.data();
+            stream.avail_in = (uInt)len;
+            do {
+                stream.next_out = (Bytef*)out.data();
+                stream.avail_out = (uInt)out.size();
+                deflate(&stream, last ? Z_FINISH : Z_NO_FLUSH);
+                int count = out.size() - stream.avail_out;
+                written += device->write(out.constData(), count);
+            } while (stream.avail_out == 0);
+        }
+
+        if (progress)
+            progress->zipProgress(fileName, total);
+        if (last)
+            break;
+    }
+    if (compress)
+        deflateEnd(&stream);
+
+    writeUInt(header.h.uncompressed_size, total);
+    writeUInt(header.h.compressed_size, written);
+    writeUInt(header.h.crc_32, crc_32);
+
+    qint64 end = device->pos();
+    h = header.h.toLocalHeader();
+    device->seek(start_of_directory);
+    device->write((const char *)&h, sizeof(LocalFileHeader));
+    device->seek(end);
+
+    fileHeaders.append(header);
+    start_of_directory = end;
+    dirtyFileTree = true;
+}
+
+/*
+ * Add many files, compressing them on a thread pool. Entries are still
+ * written one at a time in list order, so the archive and its central
+ * directory come out the same as with addFile(). Only a window of files
+ * is held in memory, and large files are streamed by this thread.
+ */
+void ZipWriterPrivate::addFiles(const QStringList &fileNames, const QStringList &sources)
+{
+    QThreadPool pool;
+    int window = pool.maxThreadCount() * 2;
+    int count = qMin(fileNames.count(), sources.count());
+    QList<DeflateTask*> tasks;
+    int next = 0;
+
+    for (int n = 0; n < count; n++) {
+        while (next < count && next < n + window) {
+            const QString &name = fileNames.at(next);
+            QFileInfo info(sources.at(next));
+            ZipWriter::CompressionPolicy compression = compressionFor(name, info.size());
+            DeflateTask *task = new DeflateTask(sources.at(next),
+                    compression == ZipWriter::AlwaysCompress,
+                    compressionPolicy == ZipWriter::AutoCompress, compressionLevel);
+            if (name.endsWith(QLatin1Char('/')) || info.size() > ZIP_PARALLEL_LIMIT)
+                task->done.release();
+            else
+                pool.start(task);
+            tasks.append(task);
+            next++;
+        }
+
+        DeflateTask *task = tasks.takeFirst();
+        task->done.acquire();
+
+        QString name = QDir::fromNativeSeparators(fileNames.at(n));
+        if (name.endsWith(QLatin1Char('/'))) {
+            addEntry(Directory, name, QByteArray());
+        }
+        else if (QFileInfo(task->path).size() > ZIP_PARALLEL_LIMIT) {
+            QFile file(task->path);
+            if (file.open(QIODevice::ReadOnly))
+                addStream(name, &file);
+            else
+                status = ZipWriter::FileOpenError;
+        }
+        else if (task->ok) {
+            writeEntry(File, name, task->data, task->crc_32, task->size, task->deflated);
+            if (progress)
+                progress->zipProgress(name, task->size);
+        }
+        else {
+            status = ZipWriter::FileOpenError;
+        }
+        delete task;
+    }
+}
+
 //////////////////////////////  Reader
 
 /*!
@@ -850,12 +1113,8 @@ ZipReader::FileInfo ZipReader::entryInfoAt(int index) const
 QByteArray ZipReader::fileData(const QString &fileName) const
 {
     d->scanFiles();
-    int i;
-    for (i = 0; i < d->fileHeaders.size(); ++i) {
-        if (QString::fromLocal8Bit(d->fileHeaders.at(i).file_name) == fileName)
-            break;
-    }
-    if (i == d->fileHeaders.size())
+    int i = d->nameIndex.value(fileName, -1);
+    if (i < 0)
         return QByteArray();
 
     FileHeader header = d->fileHeaders.at(i);
@@ -914,17 +1173,43 @@ QByteArray ZipReader::fileData(const QString &fileName) const
     return QByteArray();
 }
 
+/*!
+    Returns true if the archive has an entry named \a fileName.
+    The central directory is read once and names are looked up by hash.
+*/
+bool ZipReader::contains(const QString &fileName) const
+{
+    d->scanFiles();
+    return d->nameIndex.contains(fileName);
+}
+
 /*!
     Extracts the full contents of the zip file into \a destinationDir on
     the local filesystem.
+    If \a prefix is given, only entries starting with it are extracted and
+    the prefix is removed from their paths.
     In case writing or linking a file fails, the extraction will be aborted.
 */
-bool ZipReader::extractAll(const QString &destinationDir) const
+bool ZipReader::extractAll(const QString &destinationDir, const QString &prefix) const
 {
     QDir baseDir(destinationDir);
 
+    // entry names in the archive, before the prefix is removed
+    QStringList entries;
+    QList<FileInfo> allFiles;
+    foreach (FileInfo fi, fileInfoList()) {
+        if (!fi.filePath.startsWith(prefix))
+            continue;
+        entries.append(fi.filePath);
+        fi.filePath = fi.filePath.mid(prefix.length());
+        if (fi.filePath.isEmpty()) {
+            entries.removeLast();
+            continue;
+        }
+        allFiles.append(fi);
+    }
+
     // create directories first
-    QList<FileInfo> allFiles = fileInfoList();
     foreach (FileInfo fi, allFiles) {
         QApplication::processEvents();
         const QString absPath = destinationDir + "/" + fi.filePath;
@@ -956,7 +1241,8 @@ bool ZipReader::extractAll(const QString &destinationDir) const
     }
 #endif
 
-    foreach (FileInfo fi, allFiles) {
+    for (int n = 0; n < allFiles.count(); n++) {
+        const FileInfo &fi = allFiles.at(n);
         QApplication::processEvents();
         const QString absFile = destinationDir + "/" + fi.filePath;
         QString absPath = destinationDir + "/" + fi.filePath;
@@ -971,7 +1257,7 @@ bool ZipReader::extractAll(const QString &destinationDir) const
             QFile f(absFile);
             if (!f.open(QIODevice::WriteOnly))
                 return false;
-            f.write(fileData(fi.filePath));
+            f.write(fileData(entries.at(n)));
             //f.setPermissions(fi.permissions);
             f.close();
         }
@@ -1148,6 +1434,35 @@ ZipWriter::CompressionPolicy ZipWriter::compressionPolicy() const
     return d->compressionPolicy;
 }
 
+/*!
+    Sets the zlib compression \a level, 0 to 9, used for compressed files.
+    The default is Z_DEFAULT_COMPRESSION. With AutoCompress a level of 0
+    stores every file.
+*/
+void ZipWriter::setCompressionLevel(int level)
+{
+    d->compressionLevel = level;
+}
+
+/*!
+     Returns the zlib compression level.
+    \sa setCompressionLevel()
+*/
+int ZipWriter::compressionLevel() const
+{
+    return d->compressionLevel;
+}
+
+/*!
+    Sets a \a progress handler that is told how many bytes of the current
+    file have been read after each chunk added by addFile() from a device.
+    Pass 0 to remove it.
+*/
+void ZipWriter::setProgress(Progress *progress)
+{
+    d->progress = progress;
+}
+
 /*!
     Sets the permissions that will be used for newly added files.
 
@@ -1191,10 +1506,13 @@ void ZipWriter::addFile(const QString &fileName, const QByteArray &data)
 
 /*!
     Add a file to the archive with \a device as the source of the contents.
-    The contents returned from QIODevice::readAll() will be used as the
-    filedata.
+    The contents are read and compressed in chunks so large files do not
+    have to fit in memory. If the archive itself is not seekable the
+    contents returned from QIODevice::readAll() are used instead.
     The file will be stored in the archive using the \a fileName which
     includes the full path in the archive.
+
+    \sa setProgress()
 */
 void ZipWriter::addFile(const QString &fileName, QIODevice *device)
 {
@@ -1208,11 +1526,26 @@ void ZipWriter::addFile(const QString &fileName, QIODevice *device)
             return;
         }
     }
-    d->addEntry(ZipWriterPrivate::File, QDir::fromNativeSeparators(fileName), device->readAll());
+    if (d->device->isSequential())
+        d->addEntry(ZipWriterPrivate::File, QDir::fromNativeSeparators(fileName), device->readAll());
+    else
+        d->addStream(QDir::fromNativeSeparators(fileName), device);
     if (opened)
         device->close();
 }
 
+/*!
+    Add the files in \a sources to the archive as \a fileNames. A name that
+    ends with '/' adds a directory and its source is ignored.
+    Files are read and compressed in parallel and written in list order.
+    Status is FileOpenError if any source could not be read; the other
+    files are still added.
+*/
+void ZipWriter::addFiles(const QStringList &fileNames, const QStringList &sources)
+{
+    d->addFiles(fileNames, sources);
+}
+
 /*!
     Create a new directory in the archive with the specified \a dirName and
     the \a permissions;
@@ -28,6 +28,29 @@
 Zipper::Zipper(QObject *parent) :
     QObject(parent)
 {
+    statusDialog = NULL;
+    reader = NULL;
+}
+
+Zipper::~Zipper()
+{
+    delete reader;
+}
+
+/*
+ * All unzip calls on the same archive share one reader, so the central
+ * directory is read once however many questions are asked about it.
+ */
+ZipReader *Zipper::zipReader(QString zipName)
+{
+    QDateTime modified = QFileInfo(zipName).lastModified();
+    if(reader == NULL || readerName != zipName || readerTime != modified) {
+        delete reader;
+        reader = new ZipReader(zipName);
+        readerName = zipName;
+        readerTime = modified;
+    }
+    return reader;
 }
 
 bool Zipper::makeSpinZip(QString fileName, QStringList fileTree, QString libPath, StatusDialog *stat)
@@ -38,9 +61,10 @@ bool Zipper::makeSpinZip(QString fileName, QStringList fileTree, QString libPath
     return true;
 }
 
-bool Zipper::zipit(QString fileName, QString folder)
+bool Zipper::zipit(QString fileName, QString folder, StatusDialog *stat)
 {
     bool retval = false;
+    statusDialog = stat;
     retval = createFolderZip(fileName, folder);
     return retval;
 }
@@ -51,24 +75,20 @@ bool Zipper::zipFileList(QString source, QStringList list, QString dstZipFile)
     ZipWriter zip(dstZipFile);
     if(!zip.isWritable())
         return false;
+    zip.setProgress(this);
+    zip.setCompressionPolicy(ZipWriter::AutoCompress);
 
+    QStringList names;
+    QStringList sources;
     foreach(QString entry, list) {
         if(entry.compare(".") == 0) continue;
         if(entry.compare("..") == 0) continue;
-        if(entry.endsWith("/")) {
-            zip.addDirectory(entry);
-        } else {
-            QFile file(source+"/"+entry);
-            if(file.open(QFile::ReadOnly)) {
-                zip.addFile(entry, file.readAll());
-                file.close();
-            }
-            else {
-                retval = false;
-                break;
-            }
-        }
+        names.append(entry);
+        sources.append(source+"/"+entry);
     }
+    zip.addFiles(names, sources);
+    if(zip.status() != ZipWriter::NoError)
+        retval = false;
     zip.close();
     return retval;
 }
@@ -78,7 +98,7 @@ bool Zipper::zipFileList(QString source, QStringList list, QString dstZipFile)
 bool Zipper::unzipAll(QString fileName, QString folder, QString special)
 {
     bool rc = false;
-    ZipReader zipr(fileName);
+    ZipReader &zipr = *zipReader(fileName);
     QList<ZipReader::FileInfo> info = zipr.fileInfoList();
     bool onefolder = true;
     QString s = info.at(0).filePath;
@@ -103,18 +123,12 @@ bool Zipper::unzipAll(QString fileName, QString folder, QString special)
         rc = zipr.extractAll(folder);
     }
     else {
-        QString tmp = QDir::tempPath()+"/SimpleIDE_TempZip";
-        QDir tmpd(QDir::tempPath());
-        tmpd.mkdir(tmp);
-        rc = zipr.extractAll(tmp);
-        if(rc) {
-            if(first.compare(special) == 0) {
-                Directory::recursiveCopyDir(tmp+"/"+first, folder+"/"+special);
-            }
-            else {
-                Directory::recursiveCopyDir(tmp+"/"+first, folder);
-            }
-            Directory::recursiveRemoveDir(tmp);
+        /* drop the common top folder while extracting */
+        if(first.compare(special) == 0) {
+            rc = zipr.extractAll(folder+"/"+special, first+sep);
+        }
+        else {
+            rc = zipr.extractAll(folder, first+sep);
         }
     }
     return rc;
@@ -123,7 +137,7 @@ bool Zipper::unzipAll(QString fileName, QString folder, QString special)
 QString Zipper::unzipFirstFile(QString zipName, QString *fileName)
 {
     QByteArray bytes;
-    ZipReader zipr(zipName);
+    ZipReader &zipr = *zipReader(zipName);
     QList<ZipReader::FileInfo> info = zipr.fileInfoList();
     if(info.count() > 0) {
         *fileName = info.at(0).filePath;
@@ -135,7 +149,7 @@ QString Zipper::unzipFirstFile(QString zipName, QString *fileName)
 QString Zipper::unzipTopTypeFile(QString zipName, QString type)
 {
     QString fileName;
-    ZipReader zipr(zipName);
+    ZipReader &zipr = *zipReader(zipName);
     QList<ZipReader::FileInfo> info = zipr.fileInfoList();
     if(info.count() > 0) {
         QString name;
@@ -159,40 +173,18 @@ QString Zipper::unzipTopTypeFile(QString zipName, QString type)
 
 QString Zipper::unzipFile(QString zipName, QString fileName)
 {
-    QByteArray bytes;
-    ZipReader zipr(zipName);
-    QList<ZipReader::FileInfo> info = zipr.fileInfoList();
-    for(int n = 0; n < info.count(); n++) {
-        QApplication::processEvents();
-        if(info.at(n).filePath.compare(fileName) == 0) {
-            bytes = zipr.fileData(fileName);
-            break;
-        }
-    }
+    QByteArray bytes = zipReader(zipName)->fileData(fileName);
     return QString(bytes);
 }
 
 bool Zipper::unzipFileExists(QString zipName, QString fileName)
 {
-    QString file;
-    ZipReader zipr(zipName);
-    QList<ZipReader::FileInfo> info = zipr.fileInfoList();
-    for(int n = 0; n < info.count(); n++) {
-        QApplication::processEvents();
-        file = info.at(n).filePath;
-        qDebug() << file;
-        if(!file.compare(fileName)) {
-            return true;
-        }
-    }
-    return false;
+    return zipReader(zipName)->contains(fileName);
 }
 
 int  Zipper::unzipFileCount(QString zipName)
 {
-    ZipReader zipr(zipName);
-    QList<ZipReader::FileInfo> info = zipr.fileInfoList();
-    return info.count();
+    return zipReader(zipName)->count();
 }
 
 QString Zipper::getZipDestination(QString fileName)
@@ -266,6 +258,7 @@ void Zipper::zipSpinProjectTree(QString fileName, QStringList fileTree)
             tr("Can't create zip file")+"\n"+dstName);
         return;
     }
+    zip.setProgress(this);
     foreach(QString entry, fileTree) {
         QString name;
         if(QFile::exists(spinCodePath+"/"+entry)) {
@@ -282,7 +275,7 @@ void Zipper::zipSpinProjectTree(QString fileName, QStringList fileTree)
         }
         QFile file(name);
         if(file.open(QFile::ReadOnly)) {
-            zip.addFile(source+"/"+entry, file.readAll());
+            zip.addFile(source+"/"+entry, &file);
             file.close();
         }
     }
@@ -412,26 +405,38 @@ bool Zipper::createFolderZip(QString source, QString dstZipFile)
     ZipWriter zip(dstZipFile);
     if(!zip.isWritable())
         return false;
+    zip.setProgress(this);
+    zip.setCompressionPolicy(ZipWriter::AutoCompress);
+
+    /* the archive may be inside the folder, as with workspace backups */
+    QString archive = QFileInfo(dstZipFile).canonicalFilePath();
 
+    QStringList names;
+    QStringList sources;
     QStringList list = directoryTreeList(source);
     foreach(QString entry, list) {
-        QApplication::processEvents();
         if(entry.compare(".") == 0) continue;
         if(entry.compare("..") == 0) continue;
-        if(entry.endsWith("/")) {
-            zip.addDirectory(entry);
-        } else {
-            QFile file(source+"/"+entry);
-            if(file.open(QFile::ReadOnly)) {
-                zip.addFile(entry, file.readAll());
-                file.close();
-            }
-        }
+        QString name = source+"/"+entry;
+        if(!entry.endsWith("/") && QFileInfo(name).canonicalFilePath() == archive)
+            continue;
+        names.append(entry);
+        sources.append(name);
     }
+    zip.addFiles(names, sources);
     zip.close();
     return true;
 }
 
+void Zipper::zipProgress(const QString &fileName, qint64 bytes)
+{
+    Q_UNUSED(bytes);
+    if(statusDialog != NULL && fileName != zippingName)
+        statusDialog->setMessage(tr("Zipping: ")+shortFileName(fileName));
+    zippingName = fileName;
+    QApplication::processEvents();
+}
+
 QString Zipper::filePathName(QString fileName)
 {
     QString rets;
@@ -23,6 +23,8 @@
 #include "qtversion.h"
 
 #include "StatusDialog.h"
+#include "zipwriter.h"
+#include "zipreader.h"
 
 #if 0
 extern "C" {
@@ -31,15 +33,16 @@ extern "C" {
 }
 #endif
 
-class Zipper : public QObject
+class Zipper : public QObject, public ZipWriter::Progress
 {
     Q_OBJECT
 public:
     explicit Zipper(QObject *parent = 0);
+    virtual ~Zipper();
     // special spinzip
     bool makeSpinZip(QString fileName, QStringList fileTree, QString libPath, StatusDialog *stat);
     // any zip
-    bool zipit(QString fileName, QString folder);
+    bool zipit(QString fileName, QString folder, StatusDialog *stat = 0);
     bool zipFileList(QString source, QStringList list, QString dstZipFile);
 
     bool unzipAll(QString fileName, QString folder, QString special = "");
@@ -51,7 +54,11 @@ public:
 
     QStringList directoryTreeList(QString folder);
 
+    /* called by ZipWriter while a file is added */
+    void zipProgress(const QString &fileName, qint64 bytes);
+
 private:
+    ZipReader *zipReader(QString zipName);
     QString getZipDestination(QString fileName);
     void    zipSpinProjectTree(QString fileName, QStringList fileTree);
     bool    createFolderZip(QString source, QString dstZipFile);
@@ -61,6 +68,12 @@ private:
     QString spinLibPath;
     StatusDialog *statusDialog;
     QString newProjectFolder;
+    QString zippingName;
+
+    /* the archive being read. kept so its directory is parsed once */
+    ZipReader *reader;
+    QString    readerName;
+    QDateTime  readerTime;
 
 signals:
 
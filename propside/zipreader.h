@@ -86,7 +86,8 @@ public:
 
     FileInfo entryInfoAt(int index) const;
     QByteArray fileData(const QString &fileName) const;
-    bool extractAll(const QString &destinationDir) const;
+    bool contains(const QString &fileName) const;
+    bool extractAll(const QString &destinationDir, const QString &prefix = QString()) const;
 
     enum Status {
         NoError,
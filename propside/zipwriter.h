@@ -44,6 +44,7 @@
 
 #include <QtCore/qstring.h>
 #include <QtCore/qfile.h>
+#include <QtCore/qstringlist.h>
 
 class ZipWriterPrivate;
 
@@ -79,6 +80,18 @@ public:
     void setCompressionPolicy(CompressionPolicy policy);
     CompressionPolicy compressionPolicy() const;
 
+    class Progress
+    {
+    public:
+        virtual ~Progress() {}
+        virtual void zipProgress(const QString &fileName, qint64 bytes) = 0;
+    };
+
+    void setProgress(Progress *progress);
+
+    void setCompressionLevel(int level);
+    int compressionLevel() const;
+
     void setCreationPermissions(QFile::Permissions permissions);
     QFile::Permissions creationPermissions() const;
 
@@ -86,6 +99,8 @@ public:
 
     void addFile(const QString &fileName, QIODevice *device);
 
+    void addFiles(const QStringList &fileNames, const QStringList &sources);
+
     void addDirectory(const QString &dirName);
 
     void addSymLink(const QString &fileName, const QString &destination);